@@ -2,5 +2,26 @@
 
 #include "Aura.h"
 #include "Modules/ModuleManager.h"
+#include "Misc/CoreDelegates.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Aura, "Aura" );
+#include "AuraStats.h"
+
+class FAuraModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		// The trace counters count per frame, so they start over every frame
+		BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddStatic(&AuraStats::ResetFrameCounters);
+	}
+
+	virtual void ShutdownModule() override
+	{
+		FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+	}
+
+private:
+	FDelegateHandle BeginFrameHandle;
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FAuraModule, Aura, "Aura" );
@@ -3,15 +3,165 @@
 
 #include "AbilitySystem/AuraAbilitySystemComponent.h"
 
+/** Effect context source info */
+#include "AbilitySystem/AuraAbilityTypes.h"
+#include "GameplayEffectAggregator.h"
+
+/** Level dependent MMCs */
+#include "AbilitySystem/ModMagCalc/MMC_MaxHealth.h"
+#include "AbilitySystem/ModMagCalc/MMC_MaxMana.h"
+
+/** Regeneration */
+#include "AbilitySystem/AuraRegenerationSubsystem.h"
+#include "Engine/World.h"
+
+/** Application queue */
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
+
+#include "AuraStats.h"
+#include "AuraMemoryTracking.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Queued Applications Merged"), STAT_AuraApplicationsMerged, STATGROUP_Aura);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Queued Applications Deferred"), STAT_AuraApplicationsDeferred, STATGROUP_Aura);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Queued Applications Executed"), STAT_AuraApplicationsExecuted, STATGROUP_Aura);
+
+namespace AuraApplicationQueue
+{
+   static bool bQueueInstantEffects = true;
+   static FAutoConsoleVariableRef QueueInstantEffectsCVar(
+      TEXT("Aura.Effects.QueueInstantEffects"),
+      bQueueInstantEffects,
+      TEXT("Queue and merge the instant effects applied on the server from outside abilities, executing them on the next tick (0 executes them right away)."));
+
+   static int32 MaxApplicationsPerFrame = 8;
+   static FAutoConsoleVariableRef MaxApplicationsPerFrameCVar(
+      TEXT("Aura.Effects.MaxApplicationsPerFrame"),
+      MaxApplicationsPerFrame,
+      TEXT("Queued instant effect applications (after merging) each ASC executes per frame. The rest waits for the next frame."));
+
+   /**
+   * Instant execution multiplies each modifier magnitude by the stack count. That's N separate applications only for additive modifiers with a
+   *  magnitude that doesn't depend on the target: multiply/divide stack as 1 + (M - 1) * N, override ignores stacks, and executions, MMCs and
+   *  attribute based magnitudes are evaluated once on the merged spec instead of once after each application.
+   */
+   static bool IsStackable(const UGameplayEffect& Effect)
+   {
+      if (!Effect.Executions.IsEmpty()) return false;
+
+      for (const FGameplayModifierInfo& Modifier : Effect.Modifiers)
+      {
+         if (Modifier.ModifierOp != EGameplayModOp::Additive) return false;
+
+         const EGameplayEffectMagnitudeCalculation CalculationType = Modifier.ModifierMagnitude.GetMagnitudeCalculationType();
+         if (CalculationType != EGameplayEffectMagnitudeCalculation::ScalableFloat && CalculationType != EGameplayEffectMagnitudeCalculation::SetByCaller)
+         {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   /** Applications that would execute the same way, so they can be one application with the stack counts added up */
+   static bool CanMerge(const FGameplayEffectSpec& A, const FGameplayEffectSpec& B)
+   {
+      if (A.Def != B.Def || A.GetLevel() != B.GetLevel()) return false;
+      if (A.Def == nullptr || !IsStackable(*A.Def)) return false;
+
+      const FGameplayEffectContextHandle& ContextA = A.GetContext();
+      const FGameplayEffectContextHandle& ContextB = B.GetContext();
+      if (ContextA.GetInstigator() != ContextB.GetInstigator()
+         || ContextA.GetEffectCauser() != ContextB.GetEffectCauser()
+         || ContextA.GetSourceObject() != ContextB.GetSourceObject())
+      {
+         return false;
+      }
+
+      return A.SetByCallerTagMagnitudes.OrderIndependentCompareEqual(B.SetByCallerTagMagnitudes)
+         && A.SetByCallerNameMagnitudes.OrderIndependentCompareEqual(B.SetByCallerNameMagnitudes)
+         && A.GetDynamicAssetTags() == B.GetDynamicAssetTags();
+   }
+}
+
+namespace AuraCombatLevel
+{
+   /** Effects with a modifier calculated by one of the MMCs that read the source level from the effect context */
+   static bool ReadsSourceLevel(const UGameplayEffect& Effect)
+   {
+      for (const FGameplayModifierInfo& Modifier : Effect.Modifiers)
+      {
+         const UClass* CalculationClass = Modifier.ModifierMagnitude.GetCustomMagnitudeCalculationClass();
+         if (CalculationClass && (CalculationClass->IsChildOf<UMMC_MaxHealth>() || CalculationClass->IsChildOf<UMMC_MaxMana>()))
+         {
+            return true;
+         }
+      }
+      return false;
+   }
+}
+
 void UAuraAbilitySystemComponent::AbilityActorInfoSet()
 {
    // Bind to a delegate. We use AddObject() because it's not a dynamic delegate (we can see by checking its declaration)
    // Now EffectApplied is a callback that'll be called in response to any effect that gets applied to this ASC.
    OnGameplayEffectAppliedDelegateToSelf.AddUObject(this, &UAuraAbilitySystemComponent::EffectApplied);
+
+   // Health and Mana regeneration is done by the server for every ASC at once, and replicated from there
+   if (IsOwnerActorAuthoritative())
+   {
+      if (UAuraRegenerationSubsystem* RegenerationSubsystem = UWorld::GetSubsystem<UAuraRegenerationSubsystem>(GetWorld()))
+      {
+         RegenerationSubsystem->RegisterAbilitySystem(this);
+      }
+   }
+}
+
+void UAuraAbilitySystemComponent::SetCombatLevel(int32 NewLevel)
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(UAuraAbilitySystemComponent::SetCombatLevel);
+
+   if (!IsOwnerActorAuthoritative()) return;
+
+   /**
+   * Only our own default attribute effects (ApplyEffectToSelf) whose MMCs read the level. Effect actors make their context from our ASC as well,
+   *  but their spec level is the actor level and must not be touched.
+   */
+   TArray<FActiveGameplayEffectHandle, TInlineAllocator<4>> EffectsToUpdate;
+   for (const FActiveGameplayEffectHandle& Handle : GetActiveEffects(FGameplayEffectQuery()))
+   {
+      const FActiveGameplayEffect* ActiveEffect = GetActiveGameplayEffect(Handle);
+      if (ActiveEffect == nullptr || ActiveEffect->Spec.Def == nullptr) continue;
+
+      // The handle shares the context with the active spec, so updating it through the copy updates the spec
+      FGameplayEffectContextHandle Context = ActiveEffect->Spec.GetContext();
+      FAuraGameplayEffectContext* AuraContext = FAuraGameplayEffectContext::GetMutable(Context);
+      if (AuraContext == nullptr || !AuraContext->IsAppliedToSelf() || !AuraContext->HasSourceInfo()) continue;
+      if (AuraContext->GetSourceLevel() == NewLevel || !AuraCombatLevel::ReadsSourceLevel(*ActiveEffect->Spec.Def)) continue;
+
+      AuraContext->SetSourceLevel(NewLevel);
+      EffectsToUpdate.Add(Handle);
+   }
+   if (EffectsToUpdate.IsEmpty()) return;
+
+   /**
+   * SetActiveGameplayEffectLevel would do nothing here, since the spec level stays the same. Updating the Set By Caller magnitudes (with none to
+   *  set) always recalculates the modifier magnitudes of the effect, MMCs included, updates its aggregators and marks it dirty for replication.
+   * The batch holds the aggregator OnDirty callbacks until the end of the scope, so each changed attribute is recalculated and broadcast once,
+   *  not once per effect.
+   */
+   const TMap<FGameplayTag, float> NoSetByCallerMagnitudes;
+   FScopedAggregatorOnDirtyBatch AggregatorBatch;
+   for (const FActiveGameplayEffectHandle& Handle : EffectsToUpdate)
+   {
+      UpdateActiveGameplayEffectSetByCallerMagnitudes(Handle, NoSetByCallerMagnitudes);
+   }
 }
 
 void UAuraAbilitySystemComponent::EffectApplied(UAbilitySystemComponent* AbilitySystemComponent, const FGameplayEffectSpec& EffectSpec, FActiveGameplayEffectHandle ActiveEffectHandle)
 {
+   TRACE_CPUPROFILER_EVENT_SCOPE(UAuraAbilitySystemComponent::EffectApplied);
+   AURA_COUNT_EFFECT_APPLIED();
+
    /** 
    * To show things in the HUD we need to know about our dependencies.
    * AuraASC know nothing about our WidgetController, but the WidgetController is what broadcasts data to the widgets! Now, if we want to show something
@@ -29,3 +179,106 @@ void UAuraAbilitySystemComponent::EffectApplied(UAbilitySystemComponent* Ability
    // The WidgetController will be responsible for parsing the data (in our case the OverlayWidgetController)
    EffectAssetTags.Broadcast(TagContainer);
 }
+
+FGameplayEffectSpecHandle UAuraAbilitySystemComponent::MakeOutgoingSpec(TSubclassOf<UGameplayEffect> GameplayEffectClass, float Level, FGameplayEffectContextHandle Context) const
+{
+   LLM_SCOPE_BYTAG(Aura_EffectSpecs);
+
+   // Resolve the source info once here, instead of in every modifier execution and MMC evaluation of the spec
+   if (FAuraGameplayEffectContext* AuraContext = FAuraGameplayEffectContext::GetMutable(Context))
+   {
+      if (!AuraContext->HasSourceInfo())
+      {
+         AuraContext->ResolveSourceInfo();
+      }
+   }
+
+   return Super::MakeOutgoingSpec(GameplayEffectClass, Level, Context);
+}
+
+FActiveGameplayEffectHandle UAuraAbilitySystemComponent::ApplyGameplayEffectSpecToSelf(const FGameplayEffectSpec& GameplayEffect, FPredictionKey PredictionKey)
+{
+   if (ShouldQueueApplication(GameplayEffect, PredictionKey))
+   {
+      // What the engine gives back for an executed instant effect, so WasSuccessfullyApplied() stays true for the callers
+      QueueApplication(GameplayEffect);
+      return FActiveGameplayEffectHandle(INDEX_NONE);
+   }
+
+   LLM_SCOPE_BYTAG(Aura_ActiveEffects);
+   return Super::ApplyGameplayEffectSpecToSelf(GameplayEffect, PredictionKey);
+}
+
+bool UAuraAbilitySystemComponent::ShouldQueueApplication(const FGameplayEffectSpec& Spec, const FPredictionKey& PredictionKey) const
+{
+   if (!AuraApplicationQueue::bQueueInstantEffects || bFlushingApplicationQueue || bBypassingApplicationQueue) return false;
+   if (Spec.Def == nullptr || Spec.Def->DurationPolicy != EGameplayEffectDurationType::Instant) return false;
+
+   // Our default attributes (Primary, then Vital) execute right away, in the same frame as the Secondary infinite effect applied between them,
+   //  so Health and MaxHealth never replicate as 0
+   const FAuraGameplayEffectContext* AuraContext = FAuraGameplayEffectContext::Get(Spec.GetContext());
+   if (AuraContext && AuraContext->IsAppliedToSelf()) return false;
+
+   // Effects from abilities (costs, damage) execute now: a cost has to be paid before the ability can check it again
+   if (Spec.GetContext().GetAbility() != nullptr) return false;
+
+   // Predicted applications have to execute now to match the client; clients don't queue anything
+   return !PredictionKey.IsValidKey() && IsOwnerActorAuthoritative() && GetWorld() != nullptr;
+}
+
+FActiveGameplayEffectHandle UAuraAbilitySystemComponent::ApplyGameplayEffectSpecToSelfUnqueued(const FGameplayEffectSpec& GameplayEffect, FPredictionKey PredictionKey)
+{
+   TGuardValue<bool> BypassGuard(bBypassingApplicationQueue, true);
+   return ApplyGameplayEffectSpecToSelf(GameplayEffect, PredictionKey);
+}
+
+void UAuraAbilitySystemComponent::QueueApplication(const FGameplayEffectSpec& Spec)
+{
+   for (FGameplayEffectSpec& QueuedSpec : QueuedApplications)
+   {
+      if (AuraApplicationQueue::CanMerge(QueuedSpec, Spec))
+      {
+         // Instant effects execute their modifiers with the stack count factored in: one execution of the summed magnitudes
+         QueuedSpec.SetStackCount(QueuedSpec.GetStackCount() + Spec.GetStackCount());
+         INC_DWORD_STAT(STAT_AuraApplicationsMerged);
+         return;
+      }
+   }
+
+   QueuedApplications.Add(Spec);
+   if (!ApplicationQueueTimerHandle.IsValid())
+   {
+      ApplicationQueueTimerHandle = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UAuraAbilitySystemComponent::FlushApplicationQueue);
+   }
+}
+
+void UAuraAbilitySystemComponent::FlushApplicationQueue()
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(UAuraAbilitySystemComponent::FlushApplicationQueue);
+
+   ApplicationQueueTimerHandle.Invalidate();
+   if (QueuedApplications.IsEmpty()) return;
+
+   // Taken out first: what gets applied while flushing executes right away (bFlushingApplicationQueue) instead of going back into the queue
+   const int32 NumToExecute = FMath::Min(QueuedApplications.Num(), FMath::Max(AuraApplicationQueue::MaxApplicationsPerFrame, 1));
+   TArray<FGameplayEffectSpec> ToExecute(QueuedApplications.GetData(), NumToExecute);
+   QueuedApplications.RemoveAt(0, NumToExecute, false);
+
+   {
+      // No aggregator batch here: an instant effect can read attributes the previous one just changed (Vital after Primary), so they execute
+      //  one after the other, in the order they were applied
+      TGuardValue<bool> FlushingGuard(bFlushingApplicationQueue, true);
+      for (const FGameplayEffectSpec& Spec : ToExecute)
+      {
+         ApplyGameplayEffectSpecToSelf(Spec);
+      }
+   }
+   INC_DWORD_STAT_BY(STAT_AuraApplicationsExecuted, NumToExecute);
+
+   // Over budget: the rest goes to the next frame, in the order it came in
+   if (!QueuedApplications.IsEmpty())
+   {
+      INC_DWORD_STAT_BY(STAT_AuraApplicationsDeferred, QueuedApplications.Num());
+      ApplicationQueueTimerHandle = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UAuraAbilitySystemComponent::FlushApplicationQueue);
+   }
+}
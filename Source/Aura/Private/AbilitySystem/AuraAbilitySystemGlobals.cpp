@@ -0,0 +1,11 @@
+// Copyright Eveline Gomes.
+
+
+#include "AbilitySystem/AuraAbilitySystemGlobals.h"
+
+#include "AbilitySystem/AuraAbilityTypes.h"
+
+FGameplayEffectContext* UAuraAbilitySystemGlobals::AllocGameplayEffectContext() const
+{
+   return new FAuraGameplayEffectContext();
+}
@@ -0,0 +1,89 @@
+// Copyright Eveline Gomes.
+
+
+#include "AbilitySystem/AuraAbilitySystemLibrary.h"
+
+#include "AbilitySystemBlueprintLibrary.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystem/AuraAbilitySystemComponent.h"
+#include "AbilitySystem/AuraAttributeSet.h"
+#include "AbilitySystem/Damage/AuraDamageBatch.h"
+
+#include "AuraStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Area Damage"), STAT_AuraAreaDamage, STATGROUP_Aura);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Area Damage Targets"), STAT_AuraAreaDamageTargets, STATGROUP_Aura);
+
+int32 UAuraAbilitySystemLibrary::ApplyAreaDamage(AActor* SourceActor, const TArray<AActor*>& TargetActors, float BaseDamage, int32 Seed)
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(UAuraAbilitySystemLibrary::ApplyAreaDamage);
+   SCOPE_CYCLE_COUNTER(STAT_AuraAreaDamage);
+
+   // Health is server authoritative, clients get it through replication
+   if (SourceActor == nullptr || !SourceActor->HasAuthority()) return 0;
+
+   UAbilitySystemComponent* SourceASC = UAbilitySystemBlueprintLibrary::GetAbilitySystemComponent(SourceActor);
+   const UAuraAttributeSet* SourceAttributeSet = SourceASC ? SourceASC->GetSet<UAuraAttributeSet>() : nullptr;
+   if (SourceAttributeSet == nullptr) return 0;
+
+   FAuraAttributeSnapshot Snapshot;
+   SourceAttributeSet->GetSnapshot(Snapshot);
+
+   FAuraDamageSource Source;
+   Source.BaseDamage = BaseDamage;
+   Source.ArmorPenetration = Snapshot.Get(EAuraAttribute::ArmorPenetration);
+   Source.CriticalHitChance = Snapshot.Get(EAuraAttribute::CriticalHitChance);
+   Source.CriticalHitDamage = Snapshot.Get(EAuraAttribute::CriticalHitDamage);
+   Source.Seed = static_cast<uint32>(Seed);
+   // Every hit from this source gets its own rolls, even when the caller passes the same seed each time
+   if (UAuraAbilitySystemComponent* AuraSourceASC = Cast<UAuraAbilitySystemComponent>(SourceASC))
+   {
+      Source.Seed = HashCombine(Source.Seed, AuraSourceASC->NextDamageRollSequence());
+   }
+
+   /** Gather: one snapshot per target, one row per target in the batch */
+   FAuraDamageBatch Batch;
+   Batch.Reset(TargetActors.Num());
+   TArray<UAbilitySystemComponent*, TInlineAllocator<16>> TargetASCs;
+   // The same target listed twice (or two actors sharing an ASC) is only hit once
+   TSet<const UAbilitySystemComponent*> SeenTargetASCs;
+   SeenTargetASCs.Reserve(TargetActors.Num());
+   for (AActor* TargetActor : TargetActors)
+   {
+      UAbilitySystemComponent* TargetASC = UAbilitySystemBlueprintLibrary::GetAbilitySystemComponent(TargetActor);
+      const UAuraAttributeSet* TargetAttributeSet = TargetASC ? TargetASC->GetSet<UAuraAttributeSet>() : nullptr;
+      if (TargetAttributeSet == nullptr) continue;
+
+      bool bAlreadySeen = false;
+      SeenTargetASCs.Add(TargetASC, &bAlreadySeen);
+      if (bAlreadySeen) continue;
+
+      TargetAttributeSet->GetSnapshot(Snapshot);
+      if (Snapshot.Get(EAuraAttribute::Health) <= 0.f) continue;
+
+      Batch.AddTarget(Snapshot);
+      TargetASCs.Add(TargetASC);
+   }
+   if (Batch.Num() == 0) return 0;
+
+   Batch.Resolve(Source);
+
+   /**
+   * Write back: the new Health of every target, one after the other.
+   * This writes the base value directly, without a GE execution, so PostGameplayEffectExecute doesn't run. Its Health clamp is already done by
+   *  the batch (NewHealth is within [0, MaxHealth]). The damage is applied to the base value, so active Health modifiers stay modifiers.
+   */
+   const FGameplayAttribute HealthAttribute = UAuraAttributeSet::GetHealthAttribute();
+   int32 NumDamaged = 0;
+   for (int32 Index = 0; Index < Batch.Num(); ++Index)
+   {
+      if (Batch.NewHealth[Index] == Batch.Health[Index]) continue;
+
+      const float HealthDelta = Batch.NewHealth[Index] - Batch.Health[Index];
+      TargetASCs[Index]->SetNumericAttributeBase(HealthAttribute, TargetASCs[Index]->GetNumericAttributeBase(HealthAttribute) + HealthDelta);
+      ++NumDamaged;
+   }
+
+   INC_DWORD_STAT_BY(STAT_AuraAreaDamageTargets, Batch.Num());
+   return NumDamaged;
+}
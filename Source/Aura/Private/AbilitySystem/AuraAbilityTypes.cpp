@@ -0,0 +1,172 @@
+// Copyright Eveline Gomes.
+
+
+#include "AbilitySystem/AuraAbilityTypes.h"
+
+#include "AbilitySystemComponent.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/Controller.h"
+
+/** Interface */
+#include "Interaction/CombatInterface.h"
+
+namespace AuraEffectContext
+{
+   /** What NetSerialize sends on top of the base context */
+   enum ERepBits : uint8
+   {
+      HasAvatar = 1 << 0,
+      // Most of the time the avatar is the instigator (the base context sends it already)
+      AvatarIsInstigator = 1 << 1,
+      HasController = 1 << 2,
+      HasCharacter = 1 << 3,
+      // Same for the character and the avatar
+      CharacterIsAvatar = 1 << 4,
+      HasLevel = 1 << 5,
+
+      NumRepBits = 6
+   };
+}
+
+const FAuraGameplayEffectContext* FAuraGameplayEffectContext::Get(const FGameplayEffectContextHandle& Handle)
+{
+   const FGameplayEffectContext* Context = Handle.Get();
+   if (Context && Context->GetScriptStruct()->IsChildOf(StaticStruct()))
+   {
+      return static_cast<const FAuraGameplayEffectContext*>(Context);
+   }
+   return nullptr;
+}
+
+FAuraGameplayEffectContext* FAuraGameplayEffectContext::GetMutable(FGameplayEffectContextHandle& Handle)
+{
+   FGameplayEffectContext* Context = Handle.Get();
+   if (Context && Context->GetScriptStruct()->IsChildOf(StaticStruct()))
+   {
+      return static_cast<FAuraGameplayEffectContext*>(Context);
+   }
+   return nullptr;
+}
+
+void FAuraGameplayEffectContext::ResolveSourceInfo()
+{
+   SourceAvatarActor.Reset();
+   SourceController.Reset();
+   SourceCharacter.Reset();
+   SourceLevel = 0;
+
+   const UAbilitySystemComponent* SourceASC = GetInstigatorAbilitySystemComponent();
+   if (IsValid(SourceASC) && SourceASC->AbilityActorInfo.IsValid() && SourceASC->AbilityActorInfo->AvatarActor.IsValid())
+   {
+      AActor* AvatarActor = SourceASC->AbilityActorInfo->AvatarActor.Get();
+      SourceAvatarActor = AvatarActor;
+
+      // Same fallback SetEffectProperties used to do on every execution: no player controller in the actor info -> the pawn's controller
+      AController* Controller = SourceASC->AbilityActorInfo->PlayerController.Get();
+      if (Controller == nullptr)
+      {
+         if (const APawn* Pawn = Cast<APawn>(AvatarActor))
+         {
+            Controller = Pawn->GetController();
+         }
+      }
+      SourceController = Controller;
+      if (Controller)
+      {
+         SourceCharacter = Cast<ACharacter>(Controller->GetPawn());
+      }
+   }
+
+   // The level comes from the source object (the character that made the spec), like the MMCs did
+   if (ICombatInterface* CombatInterface = Cast<ICombatInterface>(GetSourceObject()))
+   {
+      SourceLevel = CombatInterface->GetPlayerLevel();
+   }
+   else if (ICombatInterface* AvatarCombatInterface = Cast<ICombatInterface>(SourceAvatarActor.Get()))
+   {
+      SourceLevel = AvatarCombatInterface->GetPlayerLevel();
+   }
+
+   bSourceInfoResolved = true;
+}
+
+FAuraGameplayEffectContext* FAuraGameplayEffectContext::Duplicate() const
+{
+   FAuraGameplayEffectContext* NewContext = new FAuraGameplayEffectContext();
+   *NewContext = *this;
+   if (GetHitResult())
+   {
+      // Does a deep copy of the hit result
+      NewContext->AddHitResult(*GetHitResult(), true);
+   }
+   return NewContext;
+}
+
+bool FAuraGameplayEffectContext::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+   using namespace AuraEffectContext;
+
+   Super::NetSerialize(Ar, Map, bOutSuccess);
+
+   /**
+   * One byte of flags, then only what can't be rebuilt from the base context: an object reference is only sent if it isn't the instigator
+   *  (or the avatar) already sent by Super, and the level is packed.
+   */
+   uint8 RepBits = 0;
+   if (Ar.IsSaving())
+   {
+      if (bSourceInfoResolved && SourceAvatarActor.IsValid())
+      {
+         RepBits |= HasAvatar;
+         if (SourceAvatarActor == Instigator) RepBits |= AvatarIsInstigator;
+      }
+      if (bSourceInfoResolved && SourceController.IsValid()) RepBits |= HasController;
+      if (bSourceInfoResolved && SourceCharacter.IsValid())
+      {
+         RepBits |= HasCharacter;
+         if (SourceCharacter.Get() == SourceAvatarActor.Get()) RepBits |= CharacterIsAvatar;
+      }
+      if (bSourceInfoResolved && SourceLevel != 0) RepBits |= HasLevel;
+   }
+   Ar.SerializeBits(&RepBits, NumRepBits);
+
+   if (RepBits & HasAvatar)
+   {
+      if (RepBits & AvatarIsInstigator)
+      {
+         if (Ar.IsLoading()) SourceAvatarActor = Instigator;
+      }
+      else
+      {
+         Ar << SourceAvatarActor;
+      }
+   }
+   if (RepBits & HasController)
+   {
+      Ar << SourceController;
+   }
+   if (RepBits & HasCharacter)
+   {
+      if (RepBits & CharacterIsAvatar)
+      {
+         if (Ar.IsLoading()) SourceCharacter = Cast<ACharacter>(SourceAvatarActor.Get());
+      }
+      else
+      {
+         Ar << SourceCharacter;
+      }
+   }
+   if (RepBits & HasLevel)
+   {
+      uint32 PackedLevel = static_cast<uint32>(SourceLevel);
+      Ar.SerializeIntPacked(PackedLevel);
+      SourceLevel = static_cast<int32>(PackedLevel);
+   }
+
+   if (Ar.IsLoading())
+   {
+      bSourceInfoResolved = RepBits != 0;
+   }
+
+   return true;
+}
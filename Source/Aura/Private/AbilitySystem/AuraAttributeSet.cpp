@@ -10,6 +10,15 @@
 #include "GameplayEffectExtension.h"
 #include "GameFramework/Character.h"
 #include "AbilitySystemBlueprintLibrary.h"
+#include "AbilitySystem/AuraAbilityTypes.h"
+
+/** OnRep reporting to the replication profiler */
+#include "Net/AuraAttributeNetProfiler.h"
+
+/** Attributes registry */
+#include "AuraGameplayTags.h"
+
+#include "AuraStats.h"
 
 UAuraAttributeSet::UAuraAttributeSet()
 {
@@ -28,6 +37,64 @@ UAuraAttributeSet::UAuraAttributeSet()
    //InitMana(10.f);
 }
 
+FGameplayAttribute UAuraAttributeSet::GetAttribute(EAuraAttribute Attribute)
+{
+   // Same order as EAuraAttribute
+   static const FGameplayAttribute Attributes[] =
+   {
+      GetStrengthAttribute(),
+      GetIntelligenceAttribute(),
+      GetResilienceAttribute(),
+      GetVigorAttribute(),
+      GetArmorAttribute(),
+      GetArmorPenetrationAttribute(),
+      GetBlockChanceAttribute(),
+      GetCriticalHitChanceAttribute(),
+      GetCriticalHitDamageAttribute(),
+      GetCriticalHitResistanceAttribute(),
+      GetHealthRegenerationAttribute(),
+      GetManaRegenerationAttribute(),
+      GetMaxHealthAttribute(),
+      GetMaxManaAttribute(),
+      GetHealthAttribute(),
+      GetManaAttribute()
+   };
+   static_assert(UE_ARRAY_COUNT(Attributes) == FAuraAttributeSnapshot::NumAttributes, "Attributes and EAuraAttribute are out of sync");
+
+   check(Attribute < EAuraAttribute::Num);
+   return Attributes[static_cast<int32>(Attribute)];
+}
+
+const TMap<FGameplayTag, FGameplayAttribute>& UAuraAttributeSet::GetTagsToAttributes()
+{
+   static const TMap<FGameplayTag, FGameplayAttribute> TagsToAttributes =
+   {
+      /** Primary Attributes */
+      { FAuraGameplayTags::Attributes_Primary_Strength, GetStrengthAttribute() },
+      { FAuraGameplayTags::Attributes_Primary_Intelligence, GetIntelligenceAttribute() },
+      { FAuraGameplayTags::Attributes_Primary_Resilience, GetResilienceAttribute() },
+      { FAuraGameplayTags::Attributes_Primary_Vigor, GetVigorAttribute() },
+
+      /** Secondary Attributes (MaxHealth and MaxMana already had their tags under Vital) */
+      { FAuraGameplayTags::Attributes_Secondary_Armor, GetArmorAttribute() },
+      { FAuraGameplayTags::Attributes_Secondary_ArmorPenetration, GetArmorPenetrationAttribute() },
+      { FAuraGameplayTags::Attributes_Secondary_BlockChance, GetBlockChanceAttribute() },
+      { FAuraGameplayTags::Attributes_Secondary_CriticalHitChance, GetCriticalHitChanceAttribute() },
+      { FAuraGameplayTags::Attributes_Secondary_CriticalHitDamage, GetCriticalHitDamageAttribute() },
+      { FAuraGameplayTags::Attributes_Secondary_CriticalHitResistance, GetCriticalHitResistanceAttribute() },
+      { FAuraGameplayTags::Attributes_Secondary_HealthRegeneration, GetHealthRegenerationAttribute() },
+      { FAuraGameplayTags::Attributes_Secondary_ManaRegeneration, GetManaRegenerationAttribute() },
+      { FAuraGameplayTags::Attributes_Vital_MaxHealth, GetMaxHealthAttribute() },
+      { FAuraGameplayTags::Attributes_Vital_MaxMana, GetMaxManaAttribute() },
+
+      /** Vital Attributes */
+      { FAuraGameplayTags::Attributes_Vital_Health, GetHealthAttribute() },
+      { FAuraGameplayTags::Attributes_Vital_Mana, GetManaAttribute() }
+   };
+
+   return TagsToAttributes;
+}
+
 void UAuraAttributeSet::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -64,6 +131,73 @@ void UAuraAttributeSet::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& Ou
    DOREPLIFETIME_CONDITION_NOTIFY(UAuraAttributeSet, Mana, COND_None, REPNOTIFY_Always);
 }
 
+void UAuraAttributeSet::PostRepNotifies()
+{
+   Super::PostRepNotifies();
+
+   // Only called when something was received, and the values are already in place by now
+   ++SnapshotVersion;
+}
+
+void UAuraAttributeSet::PostAttributeChange(const FGameplayAttribute& Attribute, float OldValue, float NewValue)
+{
+   Super::PostAttributeChange(Attribute, OldValue, NewValue);
+
+   if (OldValue != NewValue)
+   {
+      ++SnapshotVersion;
+   }
+}
+
+void UAuraAttributeSet::PostAttributeBaseChange(const FGameplayAttribute& Attribute, float OldValue, float NewValue) const
+{
+   Super::PostAttributeBaseChange(Attribute, OldValue, NewValue);
+
+   if (OldValue != NewValue)
+   {
+      ++SnapshotVersion;
+   }
+}
+
+void UAuraAttributeSet::GetSnapshot(FAuraAttributeSnapshot& OutSnapshot, bool bIncludeBase) const
+{
+   // Same order as EAuraAttribute
+   static FGameplayAttributeData UAuraAttributeSet::* const AttributeMembers[] =
+   {
+      &UAuraAttributeSet::Strength,
+      &UAuraAttributeSet::Intelligence,
+      &UAuraAttributeSet::Resilience,
+      &UAuraAttributeSet::Vigor,
+      &UAuraAttributeSet::Armor,
+      &UAuraAttributeSet::ArmorPenetration,
+      &UAuraAttributeSet::BlockChance,
+      &UAuraAttributeSet::CriticalHitChance,
+      &UAuraAttributeSet::CriticalHitDamage,
+      &UAuraAttributeSet::CriticalHitResistance,
+      &UAuraAttributeSet::HealthRegeneration,
+      &UAuraAttributeSet::ManaRegeneration,
+      &UAuraAttributeSet::MaxHealth,
+      &UAuraAttributeSet::MaxMana,
+      &UAuraAttributeSet::Health,
+      &UAuraAttributeSet::Mana
+   };
+   static_assert(UE_ARRAY_COUNT(AttributeMembers) == FAuraAttributeSnapshot::NumAttributes, "AttributeMembers and EAuraAttribute are out of sync");
+
+   for (int32 Index = 0; Index < FAuraAttributeSnapshot::NumAttributes; ++Index)
+   {
+      OutSnapshot.Current[Index] = (this->*AttributeMembers[Index]).GetCurrentValue();
+   }
+   if (bIncludeBase)
+   {
+      for (int32 Index = 0; Index < FAuraAttributeSnapshot::NumAttributes; ++Index)
+      {
+         OutSnapshot.Base[Index] = (this->*AttributeMembers[Index]).GetBaseValue();
+      }
+   }
+   OutSnapshot.bHasBase = bIncludeBase;
+   OutSnapshot.Version = SnapshotVersion;
+}
+
 void UAuraAttributeSet::PreAttributeChange(const FGameplayAttribute& Attribute, float& NewValue)
 {
    // IMPORTANT: remove clamping from this function. Remove this function then?
@@ -97,6 +231,8 @@ void UAuraAttributeSet::PreAttributeChange(const FGameplayAttribute& Attribute,
 
 void UAuraAttributeSet::SetEffectProperties(const FGameplayEffectModCallbackData& Data, FEffectProperties& Props) const
 {
+   TRACE_CPUPROFILER_EVENT_SCOPE(UAuraAttributeSet::SetEffectProperties);
+
    // Source = causer of the effect (source is something else that applied the effect to us)
    // Target = target of the effect (owner of this AS - us, in this context)
 
@@ -106,10 +242,19 @@ void UAuraAttributeSet::SetEffectProperties(const FGameplayEffectModCallbackData
    // Get the ASC from the source of this GE
    Props.SourceASC = Props.EffectContextHandle.GetInstigatorAbilitySystemComponent();
 
+   // Aura contexts resolved the source's avatar, controller and character when the spec was made: no need to go through the actor info again
+   const FAuraGameplayEffectContext* AuraContext = FAuraGameplayEffectContext::Get(Props.EffectContextHandle);
+   if (AuraContext && AuraContext->HasSourceInfo())
+   {
+      Props.SourceAvatarActor = AuraContext->GetSourceAvatarActor();
+      Props.SourceController = AuraContext->GetSourceController();
+      Props.SourceCharacter = AuraContext->GetSourceCharacter();
+   }
+   // Otherwise (contexts that didn't go through UAuraAbilitySystemComponent::MakeOutgoingSpec), resolve it here.
    // Since we're doing a lot of accessing pointers, we need to add some checks because not all sources might have ASC or AvatarActor.
    // TSharedPtr is a struct that has its own utilities, so we can use . operator to call those utilities. Then, once checked if that
    //  wrapper is valid, we can also use the -> operator to check if the pointer itself is valid.
-   if (IsValid(Props.SourceASC) && Props.SourceASC->AbilityActorInfo.IsValid() && Props.SourceASC->AbilityActorInfo->AvatarActor.IsValid())
+   else if (IsValid(Props.SourceASC) && Props.SourceASC->AbilityActorInfo.IsValid() && Props.SourceASC->AbilityActorInfo->AvatarActor.IsValid())
    {
       // With the SourceASC, we can get other things such as the source actor that owns the ASC
       // AvatarActor is a pointer wrapper, so we have to call .Get() on that
@@ -154,6 +299,8 @@ void UAuraAttributeSet::SetEffectProperties(const FGameplayEffectModCallbackData
 
 void UAuraAttributeSet::PostGameplayEffectExecute(const FGameplayEffectModCallbackData& Data)
 {
+   TRACE_CPUPROFILER_EVENT_SCOPE(UAuraAttributeSet::PostGameplayEffectExecute);
+
    Super::PostGameplayEffectExecute(Data);
 
    FEffectProperties Props;
@@ -177,84 +324,84 @@ void UAuraAttributeSet::PostGameplayEffectExecute(const FGameplayEffectModCallba
 
 void UAuraAttributeSet::OnRep_Strength(const FGameplayAttributeData& OldStrength) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, Strength, OldStrength);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, Strength, OldStrength);
 }
 
 void UAuraAttributeSet::OnRep_Intelligence(const FGameplayAttributeData& OldIntelligence) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, Intelligence, OldIntelligence);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, Intelligence, OldIntelligence);
 }
 
 void UAuraAttributeSet::OnRep_Resilience(const FGameplayAttributeData& OldResilience) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, Resilience, OldResilience);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, Resilience, OldResilience);
    
 }
 
 void UAuraAttributeSet::OnRep_Vigor(const FGameplayAttributeData& OldVigor) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, Vigor, OldVigor);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, Vigor, OldVigor);
 }
 
 void UAuraAttributeSet::OnRep_Armor(const FGameplayAttributeData& OldArmor) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, Armor, OldArmor);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, Armor, OldArmor);
 }
 
 void UAuraAttributeSet::OnRep_ArmorPenetration(const FGameplayAttributeData& OldArmorPenetration) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, ArmorPenetration, OldArmorPenetration);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, ArmorPenetration, OldArmorPenetration);
 }
 
 void UAuraAttributeSet::OnRep_BlockChance(const FGameplayAttributeData& OldBlockChance) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, BlockChance, OldBlockChance);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, BlockChance, OldBlockChance);
 }
 
 void UAuraAttributeSet::OnRep_CriticalHitChance(const FGameplayAttributeData& OldCriticalHitChance) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, CriticalHitChance, OldCriticalHitChance);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, CriticalHitChance, OldCriticalHitChance);
 }
 
 void UAuraAttributeSet::OnRep_CriticalHitDamage(const FGameplayAttributeData& OldCriticalHitDamage) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, CriticalHitDamage, OldCriticalHitDamage);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, CriticalHitDamage, OldCriticalHitDamage);
 }
 
 void UAuraAttributeSet::OnRep_CriticalHitResistance(const FGameplayAttributeData& OldCriticalHitResistance) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, CriticalHitResistance, OldCriticalHitResistance);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, CriticalHitResistance, OldCriticalHitResistance);
 }
 
 void UAuraAttributeSet::OnRep_HealthRegeneration(const FGameplayAttributeData& OldHealthRegeneration) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, HealthRegeneration, OldHealthRegeneration);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, HealthRegeneration, OldHealthRegeneration);
 }
 
 void UAuraAttributeSet::OnRep_ManaRegeneration(const FGameplayAttributeData& OldManaRegeneration) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, ManaRegeneration, OldManaRegeneration);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, ManaRegeneration, OldManaRegeneration);
 }
 
 void UAuraAttributeSet::OnRep_MaxHealth(const FGameplayAttributeData& OldMaxHealth) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, MaxHealth, OldMaxHealth);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, MaxHealth, OldMaxHealth);
 }
 
 void UAuraAttributeSet::OnRep_MaxMana(const FGameplayAttributeData& OldMaxMana) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, MaxMana, OldMaxMana);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, MaxMana, OldMaxMana);
 }
 
 void UAuraAttributeSet::OnRep_Health(const FGameplayAttributeData& OldHealth) const
 {
    // Inform the ability system that Health has just been replicated
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, Health, OldHealth);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, Health, OldHealth);
 }
 
 void UAuraAttributeSet::OnRep_Mana(const FGameplayAttributeData& OldMana) const
 {
-   GAMEPLAYATTRIBUTE_REPNOTIFY(UAuraAttributeSet, Mana, OldMana);
+   AURA_ATTRIBUTE_REPNOTIFY(UAuraAttributeSet, Mana, OldMana);
 }
 
 
@@ -0,0 +1,239 @@
+// Copyright Eveline Gomes.
+
+
+#include "AbilitySystem/AuraRegenerationSubsystem.h"
+
+#include "AbilitySystemComponent.h"
+#include "AbilitySystem/AuraAttributeSet.h"
+
+/** Benchmark */
+#include "GameplayEffect.h"
+#include "HAL/IConsoleManager.h"
+#include "AuraLogChannels.h"
+
+#include "AuraStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Regeneration Pass"), STAT_AuraRegenerationPass, STATGROUP_Aura);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Regeneration Writes"), STAT_AuraRegenerationWrites, STATGROUP_Aura);
+
+namespace AuraRegeneration
+{
+   static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+      TEXT("Aura.Regen.Benchmark"),
+      TEXT("Aura.Regen.Benchmark [NumAbilitySystems = 500] [NumPasses = 100]: time the regeneration subsystem against one periodic GE per ASC."),
+      FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+      {
+         UAuraRegenerationSubsystem* RegenerationSubsystem = UWorld::GetSubsystem<UAuraRegenerationSubsystem>(World);
+         if (RegenerationSubsystem == nullptr)
+         {
+            UE_LOG(LogAura, Warning, TEXT("Aura.Regen.Benchmark: needs a game world"));
+            return;
+         }
+
+         const int32 NumAbilitySystems = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 500;
+         const int32 NumPasses = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 100;
+         RegenerationSubsystem->RunBenchmark(FMath::Max(NumAbilitySystems, 1), FMath::Max(NumPasses, 1));
+      }));
+
+   /** The periodic GE the subsystem replaces: every period, adds Regeneration * Period to Health and Mana */
+   static UGameplayEffect* MakePeriodicRegenerationEffect(float Period)
+   {
+      UGameplayEffect* Effect = NewObject<UGameplayEffect>(GetTransientPackage());
+      Effect->DurationPolicy = EGameplayEffectDurationType::Infinite;
+      Effect->Period = Period;
+
+      auto AddModifier = [Effect, Period](const FGameplayAttribute& Attribute, const FGameplayAttribute& RegenerationAttribute)
+      {
+         FAttributeBasedFloat Magnitude;
+         Magnitude.Coefficient = FScalableFloat(Period);
+         Magnitude.BackingAttribute = FGameplayEffectAttributeCaptureDefinition(RegenerationAttribute, EGameplayEffectAttributeCaptureSource::Target, false);
+
+         FGameplayModifierInfo& Modifier = Effect->Modifiers.AddDefaulted_GetRef();
+         Modifier.Attribute = Attribute;
+         Modifier.ModifierOp = EGameplayModOp::Additive;
+         Modifier.ModifierMagnitude = FGameplayEffectModifierMagnitude(Magnitude);
+      };
+      AddModifier(UAuraAttributeSet::GetHealthAttribute(), UAuraAttributeSet::GetHealthRegenerationAttribute());
+      AddModifier(UAuraAttributeSet::GetManaAttribute(), UAuraAttributeSet::GetManaRegenerationAttribute());
+      return Effect;
+   }
+}
+
+void UAuraRegenerationSubsystem::RegisterAbilitySystem(UAbilitySystemComponent* AbilitySystemComponent)
+{
+   const UAuraAttributeSet* AttributeSet = AbilitySystemComponent ? AbilitySystemComponent->GetSet<UAuraAttributeSet>() : nullptr;
+   if (AttributeSet == nullptr) return;
+
+   // Actor info is set again on respawn and on possession changes
+   const bool bAlreadyRegistered = Entries.ContainsByPredicate([AbilitySystemComponent](const FRegenerationEntry& Entry)
+   {
+      return Entry.AbilitySystemComponent == AbilitySystemComponent;
+   });
+   if (bAlreadyRegistered) return;
+
+   Entries.Add({ AbilitySystemComponent, AttributeSet });
+}
+
+void UAuraRegenerationSubsystem::SetRegenerationSuspended(const UAbilitySystemComponent* AbilitySystemComponent, bool bSuspended)
+{
+   for (FRegenerationEntry& Entry : Entries)
+   {
+      if (Entry.AbilitySystemComponent == AbilitySystemComponent)
+      {
+         Entry.bSuspended = bSuspended;
+         return;
+      }
+   }
+}
+
+void UAuraRegenerationSubsystem::Tick(float DeltaTime)
+{
+   if (Entries.IsEmpty()) return;
+
+   TimeSinceLastPass += DeltaTime;
+   if (TimeSinceLastPass < RegenerationInterval) return;
+
+   // A long frame gives one pass covering all the time since the last one, not several passes in a row
+   RegeneratePass(TimeSinceLastPass);
+   TimeSinceLastPass = 0.f;
+}
+
+void UAuraRegenerationSubsystem::RegeneratePass(float ElapsedTime)
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(UAuraRegenerationSubsystem::RegeneratePass);
+   SCOPE_CYCLE_COUNTER(STAT_AuraRegenerationPass);
+
+   const FGameplayAttribute HealthAttribute = UAuraAttributeSet::GetHealthAttribute();
+   const FGameplayAttribute ManaAttribute = UAuraAttributeSet::GetManaAttribute();
+   int32 NumWrites = 0;
+
+   for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+   {
+      UAbilitySystemComponent* ASC = Entries[Index].AbilitySystemComponent.Get();
+      const UAuraAttributeSet* AttributeSet = Entries[Index].AttributeSet.Get();
+      if (ASC == nullptr || AttributeSet == nullptr)
+      {
+         // Its actor is gone (killed enemy, player who left)
+         Entries.RemoveAtSwap(Index, 1, false);
+         continue;
+      }
+
+      if (Entries[Index].bSuspended) continue;
+
+      // No regeneration for the dead
+      const float Health = AttributeSet->GetHealth();
+      if (Health <= 0.f) continue;
+
+      /**
+      * The gain goes on top of the base value, so active modifiers on Health or Mana stay modifiers instead of being folded into the base. It's
+      *  capped by what's missing from the current value, so the current value doesn't go past the current Max.
+      */
+      const float MaxHealth = AttributeSet->GetMaxHealth();
+      const float HealthRegeneration = AttributeSet->GetHealthRegeneration();
+      if (HealthRegeneration > 0.f && Health < MaxHealth)
+      {
+         const float HealthGain = FMath::Min(HealthRegeneration * ElapsedTime, MaxHealth - Health);
+         ASC->SetNumericAttributeBase(HealthAttribute, ASC->GetNumericAttributeBase(HealthAttribute) + HealthGain);
+         ++NumWrites;
+      }
+
+      const float Mana = AttributeSet->GetMana();
+      const float MaxMana = AttributeSet->GetMaxMana();
+      const float ManaRegeneration = AttributeSet->GetManaRegeneration();
+      if (ManaRegeneration > 0.f && Mana < MaxMana)
+      {
+         const float ManaGain = FMath::Min(ManaRegeneration * ElapsedTime, MaxMana - Mana);
+         ASC->SetNumericAttributeBase(ManaAttribute, ASC->GetNumericAttributeBase(ManaAttribute) + ManaGain);
+         ++NumWrites;
+      }
+   }
+
+   INC_DWORD_STAT_BY(STAT_AuraRegenerationWrites, NumWrites);
+}
+
+void UAuraRegenerationSubsystem::RunBenchmark(int32 NumAbilitySystems, int32 NumPasses)
+{
+   UWorld* World = GetWorld();
+
+   // Actors with nothing but an ASC and our attribute set, so only the regeneration itself is measured
+   TArray<AActor*> Actors;
+   TArray<UAbilitySystemComponent*> AbilitySystems;
+   Actors.Reserve(NumAbilitySystems);
+   AbilitySystems.Reserve(NumAbilitySystems);
+   for (int32 Index = 0; Index < NumAbilitySystems; ++Index)
+   {
+      AActor* Actor = World->SpawnActor<AActor>();
+      UAbilitySystemComponent* ASC = NewObject<UAbilitySystemComponent>(Actor);
+      ASC->RegisterComponent();
+      ASC->AddAttributeSetSubobject(NewObject<UAuraAttributeSet>(Actor));
+      ASC->InitAbilityActorInfo(Actor, Actor);
+
+      // Far from full, so every pass writes both attributes with either approach
+      ASC->SetNumericAttributeBase(UAuraAttributeSet::GetMaxHealthAttribute(), 1.e9f);
+      ASC->SetNumericAttributeBase(UAuraAttributeSet::GetMaxManaAttribute(), 1.e9f);
+      ASC->SetNumericAttributeBase(UAuraAttributeSet::GetHealthAttribute(), 1.f);
+      ASC->SetNumericAttributeBase(UAuraAttributeSet::GetManaAttribute(), 1.f);
+      ASC->SetNumericAttributeBase(UAuraAttributeSet::GetHealthRegenerationAttribute(), 2.f);
+      ASC->SetNumericAttributeBase(UAuraAttributeSet::GetManaRegenerationAttribute(), 2.f);
+
+      Actors.Add(Actor);
+      AbilitySystems.Add(ASC);
+   }
+
+   // Subsystem: the real pass, over the benchmark ASCs only
+   TArray<FRegenerationEntry> GameEntries = MoveTemp(Entries);
+   Entries.Reset(NumAbilitySystems);
+   for (UAbilitySystemComponent* ASC : AbilitySystems)
+   {
+      Entries.Add({ ASC, ASC->GetSet<UAuraAttributeSet>() });
+   }
+   const double SubsystemStart = FPlatformTime::Seconds();
+   for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+   {
+      RegeneratePass(RegenerationInterval);
+   }
+   const double SubsystemSeconds = FPlatformTime::Seconds() - SubsystemStart;
+   Entries = MoveTemp(GameEntries);
+
+   /**
+   * Periodic GE: each period executes the active spec on its ASC. The timers that trigger it aren't public, so a spec made once per ASC from the
+   *  same effect is executed instead: the same modifier evaluation and attribute callbacks, plus the application checks a period doesn't have.
+   */
+   const UGameplayEffect* RegenerationEffect = AuraRegeneration::MakePeriodicRegenerationEffect(RegenerationInterval);
+   TArray<FGameplayEffectSpec> Specs;
+   Specs.Reserve(NumAbilitySystems);
+   for (UAbilitySystemComponent* ASC : AbilitySystems)
+   {
+      FGameplayEffectSpec& Spec = Specs.Emplace_GetRef(RegenerationEffect, ASC->MakeEffectContext(), 1.f);
+      Spec.SetDuration(UGameplayEffect::INSTANT_APPLICATION, true);
+   }
+   const double EffectStart = FPlatformTime::Seconds();
+   for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+   {
+      for (int32 Index = 0; Index < AbilitySystems.Num(); ++Index)
+      {
+         AbilitySystems[Index]->ApplyGameplayEffectSpecToSelf(Specs[Index]);
+      }
+   }
+   const double EffectSeconds = FPlatformTime::Seconds() - EffectStart;
+
+   UE_LOG(LogAura, Display, TEXT("Regeneration benchmark, %d ASCs, %d passes | subsystem: %.3f ms per pass | periodic GE: %.3f ms per period (%.1fx)"),
+      NumAbilitySystems, NumPasses, SubsystemSeconds / NumPasses * 1000.0, EffectSeconds / NumPasses * 1000.0,
+      EffectSeconds / FMath::Max(SubsystemSeconds, UE_SMALL_NUMBER));
+
+   for (AActor* Actor : Actors)
+   {
+      Actor->Destroy();
+   }
+}
+
+TStatId UAuraRegenerationSubsystem::GetStatId() const
+{
+   RETURN_QUICK_DECLARE_CYCLE_STAT(UAuraRegenerationSubsystem, STATGROUP_Tickables);
+}
+
+bool UAuraRegenerationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+   // Gameplay worlds only, no editor preview worlds
+   return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,179 @@
+// Copyright Eveline Gomes.
+
+
+#include "AbilitySystem/Damage/AuraDamageBatch.h"
+
+#include "AbilitySystem/AuraAttributeSet.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+
+#include "AuraStats.h"
+
+namespace AuraDamage
+{
+   /** Percentages are stored as 0-100 in the attributes */
+   constexpr float Percent = 0.01f;
+   /** Share of the target's armor each point of armor penetration ignores (in %) */
+   constexpr float ArmorPenetrationCoefficient = 0.25f;
+   /** Damage reduction (in %) of each point of effective armor */
+   constexpr float EffectiveArmorCoefficient = 0.333f;
+   /** Critical hit chance (in %) each point of critical hit resistance takes away */
+   constexpr float CriticalHitResistanceCoefficient = 0.25f;
+
+   /** Roll streams, so the block and critical rolls of a target are independent */
+   constexpr uint32 BlockStream = 1;
+   constexpr uint32 CriticalHitStream = 2;
+
+   /** Targets per worker task. Small batches (a handful of enemies) aren't worth waking up workers for and stay on the calling thread. */
+   static int32 TargetsPerTask = 64;
+   static FAutoConsoleVariableRef TargetsPerTaskCVar(
+      TEXT("Aura.Damage.TargetsPerTask"),
+      TargetsPerTask,
+      TEXT("Targets resolved by each worker task of a damage batch (rounded up to a multiple of 4). 0 resolves every batch on the calling thread."));
+
+   /** Counter based random number: a hash of (seed, target, stream), uniform in [0, 1) */
+   static float Roll(uint32 Seed, uint32 TargetIndex, uint32 Stream)
+   {
+      uint32 X = Seed ^ (TargetIndex * 0x9E3779B9u) ^ (Stream * 0x85EBCA6Bu);
+      X ^= X >> 16;
+      X *= 0x7FEB352Du;
+      X ^= X >> 15;
+      X *= 0x846CA68Bu;
+      X ^= X >> 16;
+      // 24 bits, exactly representable as a float
+      return static_cast<float>(X >> 8) * (1.f / 16777216.f);
+   }
+}
+
+void FAuraDamageBatch::Reset(int32 InNumTargets)
+{
+   NumTargets = 0;
+   const int32 Capacity = Align(InNumTargets, 4);
+   for (TArray<float>* Array : { &Armor, &BlockChance, &CriticalHitResistance, &Health, &MaxHealth, &Damage, &NewHealth })
+   {
+      Array->Reset(Capacity);
+   }
+   bBlocked.Reset(Capacity);
+   bCriticalHit.Reset(Capacity);
+}
+
+int32 FAuraDamageBatch::AddTarget(const FAuraAttributeSnapshot& TargetSnapshot)
+{
+   RemovePadding();
+
+   Armor.Add(TargetSnapshot.Get(EAuraAttribute::Armor));
+   BlockChance.Add(TargetSnapshot.Get(EAuraAttribute::BlockChance));
+   CriticalHitResistance.Add(TargetSnapshot.Get(EAuraAttribute::CriticalHitResistance));
+   Health.Add(TargetSnapshot.Get(EAuraAttribute::Health));
+   MaxHealth.Add(TargetSnapshot.Get(EAuraAttribute::MaxHealth));
+
+   return NumTargets++;
+}
+
+void FAuraDamageBatch::AddPadding()
+{
+   // Padding targets have nothing: no armor, no block, no health. Their results are never read.
+   const int32 PaddedNum = Align(NumTargets, 4);
+   for (TArray<float>* Array : { &Armor, &BlockChance, &CriticalHitResistance, &Health, &MaxHealth })
+   {
+      Array->SetNumZeroed(PaddedNum);
+   }
+   Damage.SetNumUninitialized(PaddedNum);
+   NewHealth.SetNumUninitialized(PaddedNum);
+   bBlocked.SetNumUninitialized(PaddedNum);
+   bCriticalHit.SetNumUninitialized(PaddedNum);
+}
+
+void FAuraDamageBatch::RemovePadding()
+{
+   for (TArray<float>* Array : { &Armor, &BlockChance, &CriticalHitResistance, &Health, &MaxHealth, &Damage, &NewHealth })
+   {
+      Array->SetNum(FMath::Min(Array->Num(), NumTargets), false);
+   }
+   bBlocked.SetNum(FMath::Min(bBlocked.Num(), NumTargets), false);
+   bCriticalHit.SetNum(FMath::Min(bCriticalHit.Num(), NumTargets), false);
+}
+
+void FAuraDamageBatch::Resolve(const FAuraDamageSource& Source)
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(FAuraDamageBatch::Resolve);
+
+   AddPadding();
+
+   /**
+   * Each task resolves its own range of targets and only writes that range of the output arrays, and the rolls only depend on the target
+   *  index, so the results are the same whatever the number of tasks. Writing them to the attributes is left to the caller, on the game thread.
+   */
+   const int32 ChunkSize = AuraDamage::TargetsPerTask > 0 ? Align(AuraDamage::TargetsPerTask, 4) : Align(FMath::Max(NumTargets, 1), 4);
+   const int32 NumChunks = FMath::DivideAndRoundUp(NumTargets, ChunkSize);
+   ParallelFor(NumChunks, [this, &Source, ChunkSize](int32 Chunk)
+   {
+      const int32 Begin = Chunk * ChunkSize;
+      ResolveRange(Source, Begin, FMath::Min(Begin + ChunkSize, NumTargets));
+   }, NumChunks < 2 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+void FAuraDamageBatch::ResolveRange(const FAuraDamageSource& Source, int32 Begin, int32 End)
+{
+   using namespace AuraDamage;
+
+   check(Begin % 4 == 0);
+   End = Align(End, 4);
+   check(End <= Armor.Num());
+
+   /** Source values, the same in every lane */
+   const VectorRegister4Float BaseDamage = VectorSetFloat1(Source.BaseDamage);
+   // Share of the target's armor that still counts: 1 - ArmorPenetration * coefficient (%)
+   const VectorRegister4Float ArmorKept = VectorSetFloat1(FMath::Max(1.f - Source.ArmorPenetration * ArmorPenetrationCoefficient * Percent, 0.f));
+   const VectorRegister4Float ArmorReductionPerPoint = VectorSetFloat1(EffectiveArmorCoefficient * Percent);
+   const VectorRegister4Float CriticalHitChance = VectorSetFloat1(Source.CriticalHitChance * Percent);
+   const VectorRegister4Float CriticalHitResistancePerPoint = VectorSetFloat1(CriticalHitResistanceCoefficient * Percent);
+   const VectorRegister4Float CriticalHitDamage = VectorSetFloat1(Source.CriticalHitDamage);
+   const VectorRegister4Float PercentRegister = VectorSetFloat1(Percent);
+   const VectorRegister4Float Half = VectorSetFloat1(0.5f);
+   const VectorRegister4Float Two = VectorSetFloat1(2.f);
+   const VectorRegister4Float Zero = VectorZeroFloat();
+   const VectorRegister4Float One = VectorOneFloat();
+
+   for (int32 Index = Begin; Index < End; Index += 4)
+   {
+      alignas(16) float BlockRolls[4];
+      alignas(16) float CriticalHitRolls[4];
+      for (int32 Lane = 0; Lane < 4; ++Lane)
+      {
+         BlockRolls[Lane] = Roll(Source.Seed, Index + Lane, BlockStream);
+         CriticalHitRolls[Lane] = Roll(Source.Seed, Index + Lane, CriticalHitStream);
+      }
+
+      VectorRegister4Float LaneDamage = BaseDamage;
+
+      // Block: half damage
+      const VectorRegister4Float BlockMask = VectorCompareLT(VectorLoadAligned(BlockRolls), VectorMultiply(VectorLoad(&BlockChance[Index]), PercentRegister));
+      LaneDamage = VectorSelect(BlockMask, VectorMultiply(LaneDamage, Half), LaneDamage);
+
+      // Armor, after penetration: each point of effective armor takes a share of the damage away
+      const VectorRegister4Float EffectiveArmor = VectorMultiply(VectorLoad(&Armor[Index]), ArmorKept);
+      const VectorRegister4Float ArmorFactor = VectorMax(VectorSubtract(One, VectorMultiply(EffectiveArmor, ArmorReductionPerPoint)), Zero);
+      LaneDamage = VectorMultiply(LaneDamage, ArmorFactor);
+
+      // Critical hit: double damage plus the source's critical hit damage, less likely against resistant targets
+      const VectorRegister4Float EffectiveCriticalHitChance = VectorSubtract(CriticalHitChance, VectorMultiply(VectorLoad(&CriticalHitResistance[Index]), CriticalHitResistancePerPoint));
+      const VectorRegister4Float CriticalHitMask = VectorCompareLT(VectorLoadAligned(CriticalHitRolls), EffectiveCriticalHitChance);
+      LaneDamage = VectorSelect(CriticalHitMask, VectorMultiplyAdd(LaneDamage, Two, CriticalHitDamage), LaneDamage);
+
+      // Health after the hit, clamped like PostGameplayEffectExecute does
+      const VectorRegister4Float LaneNewHealth = VectorMin(VectorMax(VectorSubtract(VectorLoad(&Health[Index]), LaneDamage), Zero), VectorLoad(&MaxHealth[Index]));
+
+      VectorStore(LaneDamage, &Damage[Index]);
+      VectorStore(LaneNewHealth, &NewHealth[Index]);
+
+      const int32 BlockBits = VectorMaskBits(BlockMask);
+      const int32 CriticalHitBits = VectorMaskBits(CriticalHitMask);
+      for (int32 Lane = 0; Lane < 4; ++Lane)
+      {
+         bBlocked[Index + Lane] = (BlockBits >> Lane) & 1;
+         bCriticalHit[Index + Lane] = (CriticalHitBits >> Lane) & 1;
+      }
+   }
+}
@@ -8,6 +8,11 @@
 /** Interface */
 #include "Interaction/CombatInterface.h"
 
+/** Cached source level */
+#include "AbilitySystem/AuraAbilityTypes.h"
+
+#include "AuraStats.h"
+
 UMMC_MaxHealth::UMMC_MaxHealth()
 {
    /** 
@@ -38,6 +43,9 @@ UMMC_MaxHealth::UMMC_MaxHealth()
 
 float UMMC_MaxHealth::CalculateBaseMagnitude_Implementation(const FGameplayEffectSpec& Spec) const
 {
+   TRACE_CPUPROFILER_EVENT_SCOPE(UMMC_MaxHealth::CalculateBaseMagnitude);
+   AURA_COUNT_MMC_EVALUATION();
+
    /** 
    * Here we can get access to GT if we want and they can affect things if we also want to.
    */
@@ -73,8 +81,11 @@ float UMMC_MaxHealth::CalculateBaseMagnitude_Implementation(const FGameplayEffec
    * Once we have the CombatInterface pointer set, we can get the player level.
    */
 
-   ICombatInterface* CombatInterface = Cast<ICombatInterface>(Spec.GetContext().GetSourceObject());
-   const int32 PlayerLevel = CombatInterface->GetPlayerLevel();
+   // The Aura effect context looked the level up already, when the spec was made. Only specs made elsewhere need the cast.
+   const FAuraGameplayEffectContext* AuraContext = FAuraGameplayEffectContext::Get(Spec.GetContext());
+   const int32 PlayerLevel = AuraContext && AuraContext->HasSourceInfo()
+      ? AuraContext->GetSourceLevel()
+      : Cast<ICombatInterface>(Spec.GetContext().GetSourceObject())->GetPlayerLevel();
 
    /** 
    * With both Vigor and Player level, we can finally decide what this function returns for this modifier calculation.
@@ -9,6 +9,11 @@
 /** Interface to get the player level */
 #include "Interaction/CombatInterface.h"
 
+/** Cached source level */
+#include "AbilitySystem/AuraAbilityTypes.h"
+
+#include "AuraStats.h"
+
 UMMC_MaxMana::UMMC_MaxMana()
 {
    // Capture the attribute
@@ -22,6 +27,9 @@ UMMC_MaxMana::UMMC_MaxMana()
 
 float UMMC_MaxMana::CalculateBaseMagnitude_Implementation(const FGameplayEffectSpec& Spec) const
 {
+   TRACE_CPUPROFILER_EVENT_SCOPE(UMMC_MaxMana::CalculateBaseMagnitude);
+   AURA_COUNT_MMC_EVALUATION();
+
    // Gather tags from source and target
    const FGameplayTagContainer* SourceTags = Spec.CapturedSourceTags.GetAggregatedTags();
    const FGameplayTagContainer* TargetTags = Spec.CapturedTargetTags.GetAggregatedTags();
@@ -39,8 +47,11 @@ float UMMC_MaxMana::CalculateBaseMagnitude_Implementation(const FGameplayEffectS
 
    // Get the player level from CombatInterface by casting the source object to a combat interface object
    // The pointer won't be checked because we want the game to crash if the applied GE that uses this calculation doesn't implement a Combat Interface
-   ICombatInterface* CombatInterface = Cast<ICombatInterface>(Spec.GetContext().GetSourceObject());
-   const int32 PlayerLevel = CombatInterface->GetPlayerLevel();
+   // The Aura effect context looked the level up already, when the spec was made. Only specs made elsewhere need the cast.
+   const FAuraGameplayEffectContext* AuraContext = FAuraGameplayEffectContext::Get(Spec.GetContext());
+   const int32 PlayerLevel = AuraContext && AuraContext->HasSourceInfo()
+      ? AuraContext->GetSourceLevel()
+      : Cast<ICombatInterface>(Spec.GetContext().GetSourceObject())->GetPlayerLevel();
 
    return 50.f + 2.5f * Intelligence + 15.f * PlayerLevel;
 }
@@ -7,6 +7,8 @@
 #include "AbilitySystemBlueprintLibrary.h"
 #include "AbilitySystemComponent.h"
 
+#include "AuraStats.h"
+
 AAuraEffectActor::AAuraEffectActor()
 {
 	PrimaryActorTick.bCanEverTick = false;
@@ -50,6 +52,8 @@ void AAuraEffectActor::OnOverlap(AActor* TargetActor)
 
 void AAuraEffectActor::OnEndOverlap(AActor* TargetActor)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(AAuraEffectActor::OnEndOverlap);
+
 	if (InstantEffectApplicationPolicy == EEffectApplicationPolicy::ApplyOnEndOverlap)
 	{
 		ApplyEffectsToTarget(TargetActor, InstantGameplayEffectClasses);
@@ -100,6 +104,8 @@ void AAuraEffectActor::OnEndOverlap(AActor* TargetActor)
 
 void AAuraEffectActor::ApplyEffectToTarget(AActor* TargetActor, TSubclassOf<UGameplayEffect> GameplayEffectClass)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(AAuraEffectActor::ApplyEffectToTarget);
+
 	/** 
 	* Another option for getting the ASC of other actor is using static functions from static classes. GAS has their own library we could use
 	*  and it has a function that would cast an actor to the ASC interface or it would search for a component in the actor with ASC interface.
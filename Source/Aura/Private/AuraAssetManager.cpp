@@ -0,0 +1,149 @@
+// Copyright Eveline Gomes.
+
+
+#include "AuraAssetManager.h"
+
+/** Ability system warmup */
+#include "AbilitySystemGlobals.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "GameplayEffect.h"
+#include "GameplayModMagnitudeCalculation.h"
+
+/** Classes whose defaults reference the effects to warm up */
+#include "Actor/AuraEffectActor.h"
+#include "Character/AuraCharacterBase.h"
+#include "Engine/World.h"
+
+#include "AuraGameplayTags.h"
+#include "AuraLogChannels.h"
+#include "AuraStats.h"
+
+UAuraAssetManager& UAuraAssetManager::Get()
+{
+   check(GEngine);
+
+   UAuraAssetManager* AuraAssetManager = Cast<UAuraAssetManager>(GEngine->AssetManager);
+   checkf(AuraAssetManager, TEXT("AssetManagerClassName in DefaultEngine.ini has to be /Script/Aura.AuraAssetManager"));
+   return *AuraAssetManager;
+}
+
+void UAuraAssetManager::StartInitialLoading()
+{
+   Super::StartInitialLoading();
+
+   FAuraGameplayTags::InitializeNativeGameplayTags();
+
+   // Otherwise done lazily by the first effect context or spec made in game (globals class, tag containers, global curve and attribute tables)
+   UAbilitySystemGlobals::Get().InitGlobalData();
+
+   if (bWarmupGameplayEffects)
+   {
+      // In the editor the asset registry may still be scanning, and the class list would be incomplete
+      IAssetRegistry& AssetRegistry = GetAssetRegistry();
+      if (AssetRegistry.IsLoadingAssets())
+      {
+         AssetRegistry.OnFilesLoaded().AddUObject(this, &UAuraAssetManager::StartGameplayEffectWarmup);
+      }
+      else
+      {
+         StartGameplayEffectWarmup();
+      }
+   }
+}
+
+void UAuraAssetManager::StartGameplayEffectWarmup()
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(UAuraAssetManager::StartGameplayEffectWarmup);
+
+   IAssetRegistry& AssetRegistry = GetAssetRegistry();
+
+   // Blueprint effect classes by package, found from the asset registry without loading anything. Native classes are loaded with the module.
+   TSet<FTopLevelAssetPath> EffectClassPaths;
+   AssetRegistry.GetDerivedClassNames({ UGameplayEffect::StaticClass()->GetClassPathName() }, {}, EffectClassPaths);
+   TMap<FName, FTopLevelAssetPath> EffectClassByPackage;
+   for (const FTopLevelAssetPath& ClassPath : EffectClassPaths)
+   {
+      if (ClassPath.GetPackageName().ToString().StartsWith(TEXT("/Script/"))) continue;
+      EffectClassByPackage.Add(ClassPath.GetPackageName(), ClassPath);
+   }
+
+   /**
+   * Only the effects something will apply early: the ones the character Blueprints (default attributes) and the effect actor Blueprints
+   *  (potions, crystals...) hard reference, plus the ones a map references directly (a placed effect actor with its own effect list). Effects
+   *  only an ability uses are loaded with the ability.
+   */
+   TSet<FTopLevelAssetPath> ReferencingClassPaths;
+   AssetRegistry.GetDerivedClassNames({ AAuraCharacterBase::StaticClass()->GetClassPathName(), AAuraEffectActor::StaticClass()->GetClassPathName() }, {},
+      ReferencingClassPaths);
+   TSet<FName> ReferencingPackages;
+   for (const FTopLevelAssetPath& ClassPath : ReferencingClassPaths)
+   {
+      ReferencingPackages.Add(ClassPath.GetPackageName());
+   }
+   TArray<FAssetData> Maps;
+   AssetRegistry.GetAssetsByClass(UWorld::StaticClass()->GetClassPathName(), Maps);
+   for (const FAssetData& Map : Maps)
+   {
+      ReferencingPackages.Add(Map.PackageName);
+   }
+
+   TArray<FSoftObjectPath> ClassesToLoad;
+   TArray<FName> Dependencies;
+   for (const FName& PackageName : ReferencingPackages)
+   {
+      Dependencies.Reset();
+      AssetRegistry.GetDependencies(PackageName, Dependencies, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard);
+      for (const FName& Dependency : Dependencies)
+      {
+         if (const FTopLevelAssetPath* EffectClassPath = EffectClassByPackage.Find(Dependency))
+         {
+            ClassesToLoad.AddUnique(FSoftObjectPath(*EffectClassPath));
+         }
+      }
+   }
+
+   if (ClassesToLoad.IsEmpty())
+   {
+      bGameplayEffectWarmupComplete = true;
+      return;
+   }
+
+   GameplayEffectWarmupHandle = GetStreamableManager().RequestAsyncLoad(ClassesToLoad,
+      FStreamableDelegate::CreateUObject(this, &UAuraAssetManager::OnGameplayEffectClassesLoaded), FStreamableManager::AsyncLoadHighPriority);
+}
+
+void UAuraAssetManager::OnGameplayEffectClassesLoaded()
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(UAuraAssetManager::OnGameplayEffectClassesLoaded);
+
+   TArray<UObject*> LoadedObjects;
+   if (GameplayEffectWarmupHandle.IsValid())
+   {
+      GameplayEffectWarmupHandle->GetLoadedAssets(LoadedObjects);
+   }
+
+   for (UObject* LoadedObject : LoadedObjects)
+   {
+      UClass* EffectClass = Cast<UClass>(LoadedObject);
+      if (EffectClass == nullptr || !EffectClass->IsChildOf(UGameplayEffect::StaticClass())) continue;
+      if (EffectClass->HasAnyClassFlags(CLASS_Abstract)) continue;
+
+      // CDO, and the CDO of each custom calculation it uses
+      const UGameplayEffect* EffectCDO = EffectClass->GetDefaultObject<UGameplayEffect>();
+      for (const FGameplayModifierInfo& Modifier : EffectCDO->Modifiers)
+      {
+         if (const UClass* CalculationClass = Modifier.ModifierMagnitude.GetCustomMagnitudeCalculationClass())
+         {
+            CalculationClass->GetDefaultObject();
+         }
+      }
+
+      WarmedGameplayEffectClasses.Add(EffectClass);
+   }
+
+   // The classes are referenced by WarmedGameplayEffectClasses from now on
+   GameplayEffectWarmupHandle.Reset();
+   bGameplayEffectWarmupComplete = true;
+
+   UE_LOG(LogAura, Log, TEXT("Gameplay effect warmup: %d effect classes preloaded"), WarmedGameplayEffectClasses.Num());
+}
@@ -0,0 +1,112 @@
+// Copyright Eveline Gomes.
+
+
+#include "AuraGameplayTags.h"
+
+#include "GameplayTagsManager.h"
+#include "GameplayTagsSettings.h"
+
+#include "AuraLogChannels.h"
+
+FGameplayTag FAuraGameplayTags::Attributes_Primary_Strength;
+FGameplayTag FAuraGameplayTags::Attributes_Primary_Intelligence;
+FGameplayTag FAuraGameplayTags::Attributes_Primary_Resilience;
+FGameplayTag FAuraGameplayTags::Attributes_Primary_Vigor;
+
+FGameplayTag FAuraGameplayTags::Attributes_Secondary_Armor;
+FGameplayTag FAuraGameplayTags::Attributes_Secondary_ArmorPenetration;
+FGameplayTag FAuraGameplayTags::Attributes_Secondary_BlockChance;
+FGameplayTag FAuraGameplayTags::Attributes_Secondary_CriticalHitChance;
+FGameplayTag FAuraGameplayTags::Attributes_Secondary_CriticalHitDamage;
+FGameplayTag FAuraGameplayTags::Attributes_Secondary_CriticalHitResistance;
+FGameplayTag FAuraGameplayTags::Attributes_Secondary_HealthRegeneration;
+FGameplayTag FAuraGameplayTags::Attributes_Secondary_ManaRegeneration;
+
+FGameplayTag FAuraGameplayTags::Attributes_Vital_Health;
+FGameplayTag FAuraGameplayTags::Attributes_Vital_Mana;
+FGameplayTag FAuraGameplayTags::Attributes_Vital_MaxHealth;
+FGameplayTag FAuraGameplayTags::Attributes_Vital_MaxMana;
+
+FGameplayTag FAuraGameplayTags::Message;
+FGameplayTag FAuraGameplayTags::Message_HealthCrystal;
+FGameplayTag FAuraGameplayTags::Message_HealthPotion;
+FGameplayTag FAuraGameplayTags::Message_ManaCrystal;
+FGameplayTag FAuraGameplayTags::Message_ManaPotion;
+
+void FAuraGameplayTags::InitializeNativeGameplayTags()
+{
+   UGameplayTagsManager& Manager = UGameplayTagsManager::Get();
+   TArray<FName> NativeTagNames;
+
+   const auto AddTag = [&Manager, &NativeTagNames](FGameplayTag& OutTag, const TCHAR* TagName, const TCHAR* DevComment)
+   {
+      OutTag = Manager.AddNativeGameplayTag(FName(TagName), FString(DevComment));
+      NativeTagNames.Add(FName(TagName));
+   };
+
+   /** Primary Attributes */
+   AddTag(Attributes_Primary_Strength, TEXT("Attributes.Primary.Strength"), TEXT("Increases physical damage"));
+   AddTag(Attributes_Primary_Intelligence, TEXT("Attributes.Primary.Intelligence"), TEXT("Increases magical damage"));
+   AddTag(Attributes_Primary_Resilience, TEXT("Attributes.Primary.Resilience"), TEXT("Increases armor and armor penetration"));
+   AddTag(Attributes_Primary_Vigor, TEXT("Attributes.Primary.Vigor"), TEXT("Increases health"));
+
+   /** Secondary Attributes */
+   AddTag(Attributes_Secondary_Armor, TEXT("Attributes.Secondary.Armor"), TEXT("Reduces damage taken, improves block chance"));
+   AddTag(Attributes_Secondary_ArmorPenetration, TEXT("Attributes.Secondary.ArmorPenetration"), TEXT("Ignores a percentage of enemy armor, increases critical hit chance"));
+   AddTag(Attributes_Secondary_BlockChance, TEXT("Attributes.Secondary.BlockChance"), TEXT("Chance to cut incoming damage in half"));
+   AddTag(Attributes_Secondary_CriticalHitChance, TEXT("Attributes.Secondary.CriticalHitChance"), TEXT("Chance to double damage plus critical hit bonus"));
+   AddTag(Attributes_Secondary_CriticalHitDamage, TEXT("Attributes.Secondary.CriticalHitDamage"), TEXT("Bonus damage added when a critical hit is scored"));
+   AddTag(Attributes_Secondary_CriticalHitResistance, TEXT("Attributes.Secondary.CriticalHitResistance"), TEXT("Reduces critical hit chance of attacking enemies"));
+   AddTag(Attributes_Secondary_HealthRegeneration, TEXT("Attributes.Secondary.HealthRegeneration"), TEXT("Amount of health regenerated every second"));
+   AddTag(Attributes_Secondary_ManaRegeneration, TEXT("Attributes.Secondary.ManaRegeneration"), TEXT("Amount of mana regenerated every second"));
+
+   /** Vital Attributes */
+   AddTag(Attributes_Vital_Health, TEXT("Attributes.Vital.Health"), TEXT("Amount of damage a player can take before death"));
+   AddTag(Attributes_Vital_Mana, TEXT("Attributes.Vital.Mana"), TEXT("A resource used to cast spells"));
+   AddTag(Attributes_Vital_MaxHealth, TEXT("Attributes.Vital.MaxHealth"), TEXT("Maximum amount of health obtainable"));
+   AddTag(Attributes_Vital_MaxMana, TEXT("Attributes.Vital.MaxMana"), TEXT("Maximum amount of mana obtainable"));
+
+   /** Messages */
+   AddTag(Message, TEXT("Message"), TEXT("Root of the tags the overlay shows a message widget for"));
+   AddTag(Message_HealthCrystal, TEXT("Message.HealthCrystal"), TEXT(""));
+   AddTag(Message_HealthPotion, TEXT("Message.HealthPotion"), TEXT(""));
+   AddTag(Message_ManaCrystal, TEXT("Message.ManaCrystal"), TEXT(""));
+   AddTag(Message_ManaPotion, TEXT("Message.ManaPotion"), TEXT(""));
+
+   ValidateAgainstConfig(NativeTagNames);
+}
+
+void FAuraGameplayTags::ValidateAgainstConfig(const TArray<FName>& NativeTagNames)
+{
+#if !UE_BUILD_SHIPPING
+   const UGameplayTagsSettings* Settings = GetDefault<UGameplayTagsSettings>();
+
+   TSet<FName> ConfigTagNames;
+   for (const FGameplayTagTableRow& Row : Settings->GameplayTagList)
+   {
+      ConfigTagNames.Add(Row.Tag);
+   }
+
+   for (const FName& TagName : NativeTagNames)
+   {
+      // Root tags (eg Message) only exist in the ini as the parent of other tags
+      if (!TagName.ToString().Contains(TEXT("."))) continue;
+
+      if (!ConfigTagNames.Contains(TagName))
+      {
+         UE_LOG(LogAura, Warning, TEXT("Native gameplay tag %s isn't declared in DefaultGameplayTags.ini"), *TagName.ToString());
+      }
+   }
+
+   const TSet<FName> NativeTagSet(NativeTagNames);
+   for (const FName& TagName : ConfigTagNames)
+   {
+      const FString TagString = TagName.ToString();
+      const bool bUnderAuraRoot = TagString.StartsWith(TEXT("Attributes.")) || TagString.StartsWith(TEXT("Message."));
+      if (bUnderAuraRoot && !NativeTagSet.Contains(TagName))
+      {
+         UE_LOG(LogAura, Warning, TEXT("Gameplay tag %s in DefaultGameplayTags.ini has no native tag in FAuraGameplayTags"), *TagString);
+      }
+   }
+#endif
+}
@@ -0,0 +1,6 @@
+// Copyright Eveline Gomes.
+
+
+#include "AuraLogChannels.h"
+
+DEFINE_LOG_CATEGORY(LogAura);
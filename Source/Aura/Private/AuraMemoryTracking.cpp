@@ -0,0 +1,112 @@
+// Copyright Eveline Gomes.
+
+
+#include "AuraMemoryTracking.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/OutputDevice.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "UObject/UObjectIterator.h"
+#include "Engine/World.h"
+
+/** Objects to report */
+#include "AbilitySystem/AuraAbilitySystemComponent.h"
+#include "AbilitySystem/AuraAttributeSet.h"
+#include "UI/WidgetController/AuraWidgetController.h"
+
+LLM_DEFINE_TAG(Aura_AbilitySystem, TEXT("Aura/AbilitySystem"));
+LLM_DEFINE_TAG(Aura_AttributeSets, TEXT("Aura/AttributeSets"));
+LLM_DEFINE_TAG(Aura_ActiveEffects, TEXT("Aura/ActiveEffects"));
+LLM_DEFINE_TAG(Aura_EffectSpecs, TEXT("Aura/EffectSpecs"));
+LLM_DEFINE_TAG(Aura_WidgetControllers, TEXT("Aura/WidgetControllers"));
+
+namespace AuraMemoryTracking
+{
+   struct FOwnerClassMemory
+   {
+      int32 Owners = 0;
+      SIZE_T ASCBytes = 0;
+      SIZE_T AttributeSetBytes = 0;
+      int32 ActiveEffects = 0;
+      SIZE_T ActiveEffectBytes = 0;
+
+      SIZE_T Total() const { return ASCBytes + AttributeSetBytes + ActiveEffectBytes; }
+   };
+
+   /** Same count as "obj list": memory reachable through the object's serialized properties, containers included */
+   static SIZE_T CountObjectBytes(UObject* Object)
+   {
+      FArchiveCountMem CountMem(Object);
+      return CountMem.GetMax();
+   }
+
+   static FName GetOwnerClassName(const UObject* Object, const AActor* OwnerActor)
+   {
+      const UClass* Class = OwnerActor ? OwnerActor->GetClass() : (Object->GetOuter() ? Object->GetOuter()->GetClass() : nullptr);
+      // Native class rather than the BP ones, so all the enemy BPs end up in the AuraEnemy row
+      while (Class && !Class->HasAnyClassFlags(CLASS_Native))
+      {
+         Class = Class->GetSuperClass();
+      }
+      return Class ? Class->GetFName() : NAME_None;
+   }
+
+   static void MemReport(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+   {
+      // Per owner class of the ASC: AAuraPlayerState, AAuraEnemy
+      TMap<FName, FOwnerClassMemory> ByOwnerClass;
+
+      for (TObjectIterator<UAuraAbilitySystemComponent> It; It; ++It)
+      {
+         UAuraAbilitySystemComponent* ASC = *It;
+         if (ASC->IsTemplate() || ASC->GetWorld() != World) continue;
+
+         FOwnerClassMemory& Memory = ByOwnerClass.FindOrAdd(GetOwnerClassName(ASC, ASC->GetOwnerActor()));
+         ++Memory.Owners;
+         Memory.ASCBytes += CountObjectBytes(ASC);
+
+         // Active effects aren't reachable by serialization, so they're estimated from their count
+         const int32 NumActiveEffects = ASC->GetActiveGameplayEffects().GetNumGameplayEffects();
+         Memory.ActiveEffects += NumActiveEffects;
+         Memory.ActiveEffectBytes += NumActiveEffects * sizeof(FActiveGameplayEffect);
+      }
+
+      for (TObjectIterator<UAuraAttributeSet> It; It; ++It)
+      {
+         UAuraAttributeSet* AttributeSet = *It;
+         if (AttributeSet->IsTemplate() || AttributeSet->GetWorld() != World) continue;
+
+         FOwnerClassMemory& Memory = ByOwnerClass.FindOrAdd(GetOwnerClassName(AttributeSet, AttributeSet->GetOwningActor()));
+         Memory.AttributeSetBytes += CountObjectBytes(AttributeSet);
+      }
+
+      Ar.Logf(TEXT("Aura memory report for %s"), *GetDebugStringForWorld(World));
+      Ar.Logf(TEXT("%-32s %6s %12s %14s %10s %14s %12s %12s"), TEXT("OwnerClass"), TEXT("Count"), TEXT("ASC KB"), TEXT("AttrSet KB"),
+         TEXT("Effects"), TEXT("Effects KB"), TEXT("Total KB"), TEXT("Per owner B"));
+
+      ByOwnerClass.ValueSort([](const FOwnerClassMemory& A, const FOwnerClassMemory& B) { return A.Total() > B.Total(); });
+      for (const TPair<FName, FOwnerClassMemory>& Pair : ByOwnerClass)
+      {
+         const FOwnerClassMemory& Memory = Pair.Value;
+         Ar.Logf(TEXT("%-32s %6d %12.1f %14.1f %10d %14.1f %12.1f %12llu"), *Pair.Key.ToString(), Memory.Owners,
+            Memory.ASCBytes / 1024.0, Memory.AttributeSetBytes / 1024.0, Memory.ActiveEffects, Memory.ActiveEffectBytes / 1024.0,
+            Memory.Total() / 1024.0, static_cast<uint64>(Memory.Total() / FMath::Max(Memory.Owners, 1)));
+      }
+
+      int32 NumWidgetControllers = 0;
+      SIZE_T WidgetControllerBytes = 0;
+      for (TObjectIterator<UAuraWidgetController> It; It; ++It)
+      {
+         if (It->IsTemplate() || It->GetWorld() != World) continue;
+
+         ++NumWidgetControllers;
+         WidgetControllerBytes += CountObjectBytes(*It);
+      }
+      Ar.Logf(TEXT("Widget controllers: %d, %.1f KB"), NumWidgetControllers, WidgetControllerBytes / 1024.0);
+   }
+
+   static FAutoConsoleCommandWithWorldArgsAndOutputDevice MemReportCommand(
+      TEXT("Aura.MemReport"),
+      TEXT("Memory used by the ability system components, attribute sets and active effects of this world, per owning class, plus the widget controllers."),
+      FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&MemReport));
+}
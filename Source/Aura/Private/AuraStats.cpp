@@ -0,0 +1,19 @@
+// Copyright Eveline Gomes.
+
+
+#include "AuraStats.h"
+
+DEFINE_STAT(STAT_AuraEffectsApplied);
+DEFINE_STAT(STAT_AuraMMCEvaluations);
+DEFINE_STAT(STAT_AuraWidgetBroadcasts);
+
+TRACE_DECLARE_INT_COUNTER(AuraEffectsApplied, TEXT("Aura/EffectsAppliedPerFrame"));
+TRACE_DECLARE_INT_COUNTER(AuraMMCEvaluations, TEXT("Aura/MMCEvaluationsPerFrame"));
+TRACE_DECLARE_INT_COUNTER(AuraWidgetBroadcasts, TEXT("Aura/WidgetBroadcastsPerFrame"));
+
+void AuraStats::ResetFrameCounters()
+{
+   TRACE_COUNTER_SET(AuraEffectsApplied, 0);
+   TRACE_COUNTER_SET(AuraMMCEvaluations, 0);
+   TRACE_COUNTER_SET(AuraWidgetBroadcasts, 0);
+}
@@ -85,17 +85,27 @@ void AAuraCharacter::InitAbilityActorInfo()
    *  controlled machine that has a valid local player, we should check the subsystem instead of using an assert and proceed with adding the mapping
    *  context.
    * As we get the HUD (in this case our AuraHUD), we also need to check since it'll only be valid in the player's local machine.
+   * A dedicated server never has a HUD to init, so we skip it entirely there: compiled out for the server target, and skipped at runtime when
+   *  a game/editor build runs as a dedicated server.
    */
-   if (AAuraPlayerController* AuraPlayerController = Cast<AAuraPlayerController>(GetController()))
+#if !UE_SERVER
+   if (!IsNetMode(NM_DedicatedServer))
    {
-      // Get and check AuraHUD
-      if (AAuraHUD* AuraHUD = Cast<AAuraHUD>(AuraPlayerController->GetHUD()))
+      if (AAuraPlayerController* AuraPlayerController = Cast<AAuraPlayerController>(GetController()))
       {
-         // Call InitOverlay() and pass the args as we now have them all initialized!
-         AuraHUD->InitOverlay(AuraPlayerController, AuraPlayerState, AbilitySystemComponent, AttributeSet);
+         // Get and check AuraHUD
+         if (AAuraHUD* AuraHUD = Cast<AAuraHUD>(AuraPlayerController->GetHUD()))
+         {
+            // Call InitOverlay() and pass the args as we now have them all initialized!
+            AuraHUD->InitOverlay(AuraPlayerController, AuraPlayerState, AbilitySystemComponent, AttributeSet);
+         }
       }
    }
+#endif
 
-   // Initialize attributes as we know the ASC is valid at this point
-   InitializeDefaultAttributes();
+   // Initialize attributes as we know the ASC is valid at this point. A player coming back with a saved snapshot gets its saved state instead.
+   if (!AuraPlayerState->RestorePendingSnapshot())
+   {
+      InitializeDefaultAttributes();
+   }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "Character/AuraCharacterBase.h"
 
 #include "AbilitySystemComponent.h"
+#include "AbilitySystem/AuraAbilityTypes.h"
 
 AAuraCharacterBase::AAuraCharacterBase()
 {
@@ -64,6 +65,11 @@ void AAuraCharacterBase::ApplyEffectToSelf(TSubclassOf<UGameplayEffect> Gameplay
 	// Set the source object ('this' represents the charcter object that can be Aura or the in the case of the Enemy, the source object is the
 	//  class that has the implemented interface function GetPlayerLevel from our CombaitInterface)
 	ContextHandle.AddSourceObject(this);
+	// Our own default attributes: they follow our level and are part of the saved progression
+	if (FAuraGameplayEffectContext* AuraContext = FAuraGameplayEffectContext::GetMutable(ContextHandle))
+	{
+		AuraContext->SetAppliedToSelf(true);
+	}
 	// Create a GameplayEffectSpec
 	const FGameplayEffectSpecHandle SpecHandle = GetAbilitySystemComponent()->MakeOutgoingSpec(GameplayEffectClass, Level, ContextHandle);
 	GetAbilitySystemComponent()->ApplyGameplayEffectSpecToTarget(*SpecHandle.Data.Get(), GetAbilitySystemComponent());
@@ -10,6 +10,13 @@
 #include "AbilitySystem/AuraAbilitySystemComponent.h"
 #include "AbilitySystem/AuraAttributeSet.h"
 
+/** Hibernation */
+#include "Engine/World.h"
+#include "Save/AuraEnemyHibernationSubsystem.h"
+
+/** Memory tracking */
+#include "AuraMemoryTracking.h"
+
 AAuraEnemy::AAuraEnemy()
 {
    PrimaryActorTick.bCanEverTick = true;
@@ -18,31 +25,41 @@ AAuraEnemy::AAuraEnemy()
    GetMesh()->SetCollisionResponseToChannel(ECC_Visibility, ECR_Block);
 
    // Construct AuraAbilitySystemComponent
-   AbilitySystemComponent = CreateDefaultSubobject<UAuraAbilitySystemComponent>("AbilitySystemComponent");
+   {
+      LLM_SCOPE_BYTAG(Aura_AbilitySystem);
+      AbilitySystemComponent = CreateDefaultSubobject<UAuraAbilitySystemComponent>("AbilitySystemComponent");
+   }
    // Make sure it is replicated
    AbilitySystemComponent->SetIsReplicated(true);
    // Set replication mode for this component
    AbilitySystemComponent->SetReplicationMode(EGameplayEffectReplicationMode::Minimal);
 
    // Construct AttributeSet
-   AttributeSet = CreateDefaultSubobject<UAuraAttributeSet>("AttributeSet");
+   {
+      LLM_SCOPE_BYTAG(Aura_AttributeSets);
+      AttributeSet = CreateDefaultSubobject<UAuraAttributeSet>("AttributeSet");
+   }
 }
 
 void AAuraEnemy::HighlightActor()
 {
+   // Highlighting is only visual (custom depth in the post process), there's nothing to render on the server target
+#if !UE_SERVER
    // Set Render Custom Depth so the mesh uses the material we've added to the post process volume
    GetMesh()->SetRenderCustomDepth(true);
    GetMesh()->SetCustomDepthStencilValue(CUSTOM_DEPTH_RED); // once we set it, we don't need to set it again so it's a redundent operation (but it's cheap so we'll leave it)
    // Since weapon is created in the parent class (AuraCharacterBase) we don't expect Highlight being called before Weapon is a valid ptr
    Weapon->SetRenderCustomDepth(true);
    Weapon->SetCustomDepthStencilValue(CUSTOM_DEPTH_RED);
-
+#endif
 }
 
 void AAuraEnemy::UnHighlihtActor()
 {
+#if !UE_SERVER
    GetMesh()->SetRenderCustomDepth(false);
    Weapon->SetRenderCustomDepth(false);
+#endif
 }
 
 void AAuraEnemy::Tick(float DeltaTime)
@@ -62,10 +79,33 @@ void AAuraEnemy::BeginPlay()
    InitAbilityActorInfo();
 }
 
+void AAuraEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+   // Streamed out (not killed, not the end of the game): keep its state for when the level comes back
+   if (EndPlayReason == EEndPlayReason::RemovedFromWorld && HasAuthority())
+   {
+      if (UAuraEnemyHibernationSubsystem* HibernationSubsystem = UWorld::GetSubsystem<UAuraEnemyHibernationSubsystem>(GetWorld()))
+      {
+         HibernationSubsystem->Hibernate(this, *AbilitySystemComponent, Level);
+      }
+   }
+
+   Super::EndPlay(EndPlayReason);
+}
+
 void AAuraEnemy::InitAbilityActorInfo()
 {
    // Initialize Actor Info
    AbilitySystemComponent->InitAbilityActorInfo(this, this);
    // Call AbilityActorInfoSet() from AuraAbilitySystemComponent class, so it knows the ASC has been set!
    Cast<UAuraAbilitySystemComponent>(AbilitySystemComponent)->AbilityActorInfoSet();
+
+   // Back from a streamed out level: restore the state it had instead of starting over
+   if (HasAuthority())
+   {
+      if (UAuraEnemyHibernationSubsystem* HibernationSubsystem = UWorld::GetSubsystem<UAuraEnemyHibernationSubsystem>(GetWorld()))
+      {
+         HibernationSubsystem->Rehydrate(this, *AbilitySystemComponent, [this](int32 SavedLevel) { Level = SavedLevel; });
+      }
+   }
 }
@@ -3,3 +3,52 @@
 
 #include "Game/AuraGameModeBase.h"
 
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/Paths.h"
+#include "Player/AuraPlayerState.h"
+#include "Save/AuraAutosaveSubsystem.h"
+
+void AAuraGameModeBase::PostLogin(APlayerController* NewPlayer)
+{
+   AAuraPlayerState* AuraPlayerState = bPersistPlayerSnapshots && NewPlayer ? NewPlayer->GetPlayerState<AAuraPlayerState>() : nullptr;
+
+   // Before Super: it spawns and possesses the pawn, whose InitAbilityActorInfo restores the snapshot
+   const FString SlotName = AuraPlayerState ? GetSnapshotSlotName(AuraPlayerState) : FString();
+   const bool bHasSnapshot = AuraPlayerState && AuraPlayerState->LoadSnapshot(SlotName);
+
+   Super::PostLogin(NewPlayer);
+
+   // From here on the autosave keeps the slot up to date
+   if (AuraPlayerState)
+   {
+      if (UAuraAutosaveSubsystem* AutosaveSubsystem = UWorld::GetSubsystem<UAuraAutosaveSubsystem>(GetWorld()))
+      {
+         AutosaveSubsystem->RegisterPlayer(AuraPlayerState, SlotName, bHasSnapshot);
+      }
+   }
+}
+
+void AAuraGameModeBase::Logout(AController* Exiting)
+{
+   if (bPersistPlayerSnapshots && Exiting)
+   {
+      if (AAuraPlayerState* AuraPlayerState = Exiting->GetPlayerState<AAuraPlayerState>())
+      {
+         if (UAuraAutosaveSubsystem* AutosaveSubsystem = UWorld::GetSubsystem<UAuraAutosaveSubsystem>(GetWorld()))
+         {
+            AutosaveSubsystem->UnregisterPlayer(AuraPlayerState);
+         }
+         // Full snapshot: it replaces whatever the autosave journaled
+         AuraPlayerState->SaveSnapshot(GetSnapshotSlotName(AuraPlayerState));
+      }
+   }
+
+   Super::Logout(Exiting);
+}
+
+FString AAuraGameModeBase::GetSnapshotSlotName(const APlayerState* PlayerState)
+{
+   const FString PlayerId = PlayerState->GetUniqueId().IsValid() ? PlayerState->GetUniqueId().ToString() : PlayerState->GetPlayerName();
+   return FPaths::MakeValidFileName(PlayerId, TEXT('_'));
+}
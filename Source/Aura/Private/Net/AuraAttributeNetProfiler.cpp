@@ -0,0 +1,198 @@
+// Copyright Eveline Gomes.
+
+
+#include "Net/AuraAttributeNetProfiler.h"
+
+#include "AttributeSet.h"
+#include "Engine/Engine.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/CoreNet.h"
+
+#include "AuraLogChannels.h"
+
+namespace AuraAttributeNetProfiler
+{
+#if AURA_ATTRIBUTE_NET_PROFILER
+   static FAutoConsoleCommand StartCommand(
+      TEXT("Aura.Net.AttributeProfiler.Start"),
+      TEXT("Start recording attribute replication per connection, owning class and attribute."),
+      FConsoleCommandDelegate::CreateLambda([]() { FAuraAttributeNetProfiler::Get().Start(); }));
+
+   static FAutoConsoleCommand StopCommand(
+      TEXT("Aura.Net.AttributeProfiler.Stop"),
+      TEXT("Stop recording attribute replication and write the CSV to Saved/Profiling/AuraAttributeNet."),
+      FConsoleCommandDelegate::CreateLambda([]() { FAuraAttributeNetProfiler::Get().Stop(); }));
+#endif
+
+   /** The replicated FGameplayAttributeData properties of a set, in declaration order (which is also the order of their rep handles) */
+   static void GetReplicatedAttributes(const UClass* AttributeSetClass, TArray<const FStructProperty*>& OutAttributes)
+   {
+      for (TFieldIterator<FStructProperty> It(AttributeSetClass); It; ++It)
+      {
+         if (It->Struct == FGameplayAttributeData::StaticStruct() && It->HasAnyPropertyFlags(CPF_Net))
+         {
+            OutAttributes.Add(*It);
+         }
+      }
+   }
+
+   /** Bits the rep layout writes for one changed member: its handle, packed, then the value through the property's net serializer */
+   static int64 GetMemberBits(uint32 Handle, const FProperty* MemberProperty, float Value)
+   {
+      FNetBitWriter Writer(nullptr, 128);
+      Writer.SerializeIntPacked(Handle);
+      MemberProperty->NetSerializeItem(Writer, nullptr, &Value);
+      return Writer.GetNumBits();
+   }
+
+   static FString GetConnectionName(UNetConnection* Connection)
+   {
+      const APlayerState* PlayerState = Connection->PlayerController ? Connection->PlayerController->PlayerState : nullptr;
+      FString Name = Connection->LowLevelGetRemoteAddress(true);
+      if (PlayerState)
+      {
+         Name += TEXT(" ") + PlayerState->GetPlayerName();
+      }
+      // Keep the CSV columns intact
+      return Name.Replace(TEXT(","), TEXT(" "));
+   }
+}
+
+FAuraAttributeNetProfiler& FAuraAttributeNetProfiler::Get()
+{
+   static FAuraAttributeNetProfiler Profiler;
+   return Profiler;
+}
+
+void FAuraAttributeNetProfiler::Start()
+{
+   Rows.Reset();
+   Shadows.Reset();
+   StartTime = FPlatformTime::Seconds();
+   bRunning = true;
+   UE_LOG(LogAura, Display, TEXT("Attribute net profiler started"));
+}
+
+void FAuraAttributeNetProfiler::Stop()
+{
+   if (!bRunning) return;
+
+   bRunning = false;
+   WriteCSV(FPlatformTime::Seconds() - StartTime);
+   Rows.Reset();
+   Shadows.Reset();
+}
+
+void FAuraAttributeNetProfiler::RecordReplicatedActor(UNetConnection* Connection, const UAttributeSet* AttributeSet, uint32 RepFrame)
+{
+   using namespace AuraAttributeNetProfiler;
+
+   TArray<const FStructProperty*, TInlineAllocator<32>> Attributes;
+   GetReplicatedAttributes(AttributeSet->GetClass(), Attributes);
+
+   FConnectionShadow& Shadow = Shadows.FindOrAdd({ Connection, AttributeSet });
+   if (Shadow.LastRepFrame == RepFrame) return;
+
+   // First time we see this set on this connection: it may have been replicated before the recording started, so this only seeds the shadow
+   const bool bSeeding = Shadow.LastRepFrame == MAX_uint32;
+   Shadow.LastRepFrame = RepFrame;
+   Shadow.BaseValues.SetNumZeroed(Attributes.Num());
+   Shadow.CurrentValues.SetNumZeroed(Attributes.Num());
+
+   static const FProperty* BaseValueProperty = FindFProperty<FProperty>(FGameplayAttributeData::StaticStruct(), TEXT("BaseValue"));
+   static const FProperty* CurrentValueProperty = FindFProperty<FProperty>(FGameplayAttributeData::StaticStruct(), TEXT("CurrentValue"));
+
+   FString ConnectionName;
+   const AActor* OwningActor = AttributeSet->GetOwningActor();
+
+   for (int32 Index = 0; Index < Attributes.Num(); ++Index)
+   {
+      const FGameplayAttributeData* Data = Attributes[Index]->ContainerPtrToValuePtr<FGameplayAttributeData>(AttributeSet);
+      const float BaseValue = Data->GetBaseValue();
+      const float CurrentValue = Data->GetCurrentValue();
+      const bool bBaseChanged = BaseValue != Shadow.BaseValues[Index];
+      const bool bCurrentChanged = CurrentValue != Shadow.CurrentValues[Index];
+      Shadow.BaseValues[Index] = BaseValue;
+      Shadow.CurrentValues[Index] = CurrentValue;
+      if (bSeeding || (!bBaseChanged && !bCurrentChanged)) continue;
+
+      if (ConnectionName.IsEmpty())
+      {
+         ConnectionName = GetConnectionName(Connection);
+      }
+
+      FRowKey Key;
+      Key.Connection = ConnectionName;
+      Key.OwnerClass = OwningActor ? OwningActor->GetClass()->GetFName() : NAME_None;
+      Key.Attribute = Attributes[Index]->GetFName();
+
+      // Each member of the struct gets its own handle in the rep layout; the handle here is estimated from the declaration order
+      FRowCounters& Counters = Rows.FindOrAdd(Key);
+      ++Counters.Updates;
+      if (bBaseChanged)
+      {
+         Counters.Bits += GetMemberBits(Index * 2 + 1, BaseValueProperty, BaseValue);
+      }
+      if (bCurrentChanged)
+      {
+         Counters.Bits += GetMemberBits(Index * 2 + 2, CurrentValueProperty, CurrentValue);
+      }
+   }
+}
+
+void FAuraAttributeNetProfiler::RecordRepNotify(const UAttributeSet* AttributeSet, FName AttributeName, const FGameplayAttributeData& OldValue, const FGameplayAttributeData& NewValue)
+{
+   const AActor* OwningActor = AttributeSet->GetOwningActor();
+
+   FRowKey Key;
+   // "Client 1", "Client 2"... so PIE clients in the same process end up in different rows
+   Key.Connection = GetDebugStringForWorld(AttributeSet->GetWorld()) + TEXT(" (received)");
+   Key.OwnerClass = OwningActor ? OwningActor->GetClass()->GetFName() : NAME_None;
+   Key.Attribute = AttributeName;
+
+   FRowCounters& Counters = Rows.FindOrAdd(Key);
+   ++Counters.Updates;
+   if (OldValue.GetBaseValue() == NewValue.GetBaseValue() && OldValue.GetCurrentValue() == NewValue.GetCurrentValue())
+   {
+      ++Counters.UnchangedOnReps;
+   }
+}
+
+void FAuraAttributeNetProfiler::WriteCSV(double Duration) const
+{
+   // Sorted rows so two CSVs from different builds can be diffed line by line
+   TArray<FRowKey> Keys;
+   Rows.GetKeys(Keys);
+   Keys.Sort([](const FRowKey& A, const FRowKey& B)
+   {
+      if (A.Connection != B.Connection) return A.Connection < B.Connection;
+      if (A.OwnerClass != B.OwnerClass) return A.OwnerClass.LexicalLess(B.OwnerClass);
+      return A.Attribute.LexicalLess(B.Attribute);
+   });
+
+   const double Seconds = FMath::Max(Duration, UE_SMALL_NUMBER);
+   FString CSV = FString::Printf(TEXT("# %.1f seconds\n"), Duration);
+   CSV += TEXT("Connection,OwnerClass,Attribute,Updates,Bytes,UnchangedOnReps,UpdatesPerSecond,BytesPerSecond\n");
+   for (const FRowKey& Key : Keys)
+   {
+      const FRowCounters& Counters = Rows.FindChecked(Key);
+      const double Bytes = Counters.Bits / 8.0;
+      CSV += FString::Printf(TEXT("%s,%s,%s,%d,%.0f,%d,%.2f,%.1f\n"), *Key.Connection, *Key.OwnerClass.ToString(), *Key.Attribute.ToString(),
+         Counters.Updates, Bytes, Counters.UnchangedOnReps, Counters.Updates / Seconds, Bytes / Seconds);
+   }
+
+   const FString FilePath = FPaths::ProfilingDir() / TEXT("AuraAttributeNet") / FString::Printf(TEXT("AttributeNet_%s.csv"), *FDateTime::Now().ToString());
+   if (FFileHelper::SaveStringToFile(CSV, *FilePath))
+   {
+      UE_LOG(LogAura, Display, TEXT("Attribute net profiler: wrote %d rows over %.1f s to %s"), Keys.Num(), Duration, *FilePath);
+   }
+   else
+   {
+      UE_LOG(LogAura, Error, TEXT("Attribute net profiler: couldn't write %s"), *FilePath);
+   }
+}
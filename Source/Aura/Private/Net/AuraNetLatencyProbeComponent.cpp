@@ -0,0 +1,252 @@
+// Copyright Eveline Gomes.
+
+
+#include "Net/AuraNetLatencyProbeComponent.h"
+
+/** GAS */
+#include "AbilitySystemBlueprintLibrary.h"
+#include "AbilitySystem/AuraAbilitySystemComponent.h"
+#include "AbilitySystem/AuraAttributeSet.h"
+#include "AbilitySystem/AuraRegenerationSubsystem.h"
+
+/** Ping */
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+
+/** Overlay broadcasts */
+#include "UI/HUD/AuraHUD.h"
+#include "UI/WidgetController/OverlayWidgetController.h"
+
+#include "AuraLogChannels.h"
+#include "TimerManager.h"
+
+namespace AuraNetLatencyProbe
+{
+   static void LogSamples(const TCHAR* Label, const FString& TargetName, const FString& ASCOwnerName, TArray<double>& Samples, int32 LostSamples)
+   {
+      if (Samples.IsEmpty())
+      {
+         UE_LOG(LogAura, Display, TEXT("Latency probe on %s (%s), %s: no samples received, %d lost"), *TargetName, *ASCOwnerName, Label, LostSamples);
+         return;
+      }
+
+      Samples.Sort();
+      double Sum = 0.0;
+      for (const double Sample : Samples)
+      {
+         Sum += Sample;
+      }
+      const int32 P95Index = FMath::Min(FMath::CeilToInt(Samples.Num() * 0.95) - 1, Samples.Num() - 1);
+
+      UE_LOG(LogAura, Display, TEXT("Latency probe on %s (%s), %s: %d samples, %d lost | min %.1f ms, avg %.1f ms, p95 %.1f ms, max %.1f ms"),
+         *TargetName, *ASCOwnerName, Label, Samples.Num(), LostSamples,
+         Samples[0] * 1000.0, Sum / Samples.Num() * 1000.0, Samples[P95Index] * 1000.0, Samples.Last() * 1000.0);
+   }
+}
+
+UAuraNetLatencyProbeComponent::UAuraNetLatencyProbeComponent()
+{
+   PrimaryComponentTick.bCanEverTick = false;
+   // The server RPC goes through this component, so it has to replicate along with its owner (the player controller)
+   SetIsReplicatedByDefault(true);
+}
+
+void UAuraNetLatencyProbeComponent::StartProbe(int32 NumSamples, AActor* Target)
+{
+   if (bAwaitingSample || SamplesRemaining > 0)
+   {
+      UE_LOG(LogAura, Warning, TEXT("Latency probe already running"));
+      return;
+   }
+
+   UAbilitySystemComponent* TargetASC = UAbilitySystemBlueprintLibrary::GetAbilitySystemComponent(Target);
+   if (TargetASC == nullptr)
+   {
+      UE_LOG(LogAura, Warning, TEXT("Latency probe: %s has no ability system component"), *GetNameSafe(Target));
+      return;
+   }
+
+   ProbedASC = TargetASC;
+   ProbedActor = Target;
+   SamplesRemaining = FMath::Max(NumSamples, 1);
+   SampleIndex = 0;
+   LostSamples = 0;
+   LostOverlaySamples = 0;
+   bAwaitingOverlaySample = false;
+   Samples.Reset(SamplesRemaining);
+   OverlaySamples.Reset(SamplesRemaining);
+
+   HealthChangedHandle = TargetASC->GetGameplayAttributeValueChangeDelegate(UAuraAttributeSet::GetHealthAttribute())
+      .AddUObject(this, &UAuraNetLatencyProbeComponent::OnProbedHealthChanged);
+
+   // The overlay only shows our own player's attributes
+   const APlayerController* PC = Cast<APlayerController>(GetOwner());
+   if (PC && PC->GetPawn() == Target)
+   {
+      const AAuraHUD* AuraHUD = Cast<AAuraHUD>(PC->GetHUD());
+      if (UOverlayWidgetController* OverlayController = AuraHUD ? AuraHUD->GetOverlayWidgetController() : nullptr)
+      {
+         OverlayController->OnHealthChanged.AddUniqueDynamic(this, &UAuraNetLatencyProbeComponent::OnOverlayHealthChanged);
+         ProbedOverlayController = OverlayController;
+      }
+   }
+
+   ServerSetProbeActive(Target, true);
+   GetWorld()->GetTimerManager().SetTimer(SampleTimerHandle, this, &UAuraNetLatencyProbeComponent::SendNextSample, SampleInterval, true, 0.f);
+}
+
+void UAuraNetLatencyProbeComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+   StopListening();
+   GetWorld()->GetTimerManager().ClearTimer(SampleTimerHandle);
+
+   Super::EndPlay(EndPlayReason);
+}
+
+void UAuraNetLatencyProbeComponent::SendNextSample()
+{
+   const double Now = FPlatformTime::Seconds();
+
+   // The previous sample never arrived (lost, or the target wasn't relevant anymore)
+   if (bAwaitingSample && Now - SampleSentTime > SampleTimeout)
+   {
+      bAwaitingSample = false;
+      ++LostSamples;
+   }
+   if (bAwaitingSample) return;
+
+   // The overlay didn't broadcast the previous value before the next sample
+   if (bAwaitingOverlaySample)
+   {
+      bAwaitingOverlaySample = false;
+      ++LostOverlaySamples;
+   }
+
+   if (SamplesRemaining <= 0 || !ProbedActor.IsValid())
+   {
+      FinishProbe();
+      return;
+   }
+
+   // Half of the round trip time is used as the client -> server part of the sample
+   const APlayerController* PC = Cast<APlayerController>(GetOwner());
+   const APlayerState* PS = PC ? PC->PlayerState : nullptr;
+   SampleOneWayTime = PS ? PS->GetPingInMilliseconds() * 0.0005 : 0.0;
+
+   --SamplesRemaining;
+   bAwaitingSample = true;
+   SampleSentTime = Now;
+   ExpectedHealthDelta = GetProbeMagnitude(SampleIndex);
+   ServerApplyProbeEffect(ProbedActor.Get(), SampleIndex++);
+}
+
+void UAuraNetLatencyProbeComponent::OnProbedHealthChanged(const FOnAttributeChangeData& Data)
+{
+   if (!bAwaitingSample) return;
+   // Damage or any other Health change isn't our sample: only the step the server was asked for is
+   if (!FMath::IsNearlyEqual(Data.NewValue - Data.OldValue, ExpectedHealthDelta)) return;
+
+   bAwaitingSample = false;
+   Samples.Add(FMath::Max(FPlatformTime::Seconds() - SampleSentTime - SampleOneWayTime, 0.0));
+
+   // Same value again, coming out of the overlay widget controller this time
+   if (ProbedOverlayController.IsValid())
+   {
+      bAwaitingOverlaySample = true;
+      ExpectedOverlayHealth = Data.NewValue;
+   }
+}
+
+void UAuraNetLatencyProbeComponent::OnOverlayHealthChanged(float NewValue)
+{
+   if (!bAwaitingOverlaySample || !FMath::IsNearlyEqual(NewValue, ExpectedOverlayHealth)) return;
+
+   bAwaitingOverlaySample = false;
+   OverlaySamples.Add(FMath::Max(FPlatformTime::Seconds() - SampleSentTime - SampleOneWayTime, 0.0));
+}
+
+void UAuraNetLatencyProbeComponent::FinishProbe()
+{
+   GetWorld()->GetTimerManager().ClearTimer(SampleTimerHandle);
+   const bool bProbedOverlay = ProbedOverlayController.IsValid();
+   StopListening();
+
+   // The ASC owner tells the replication mode apart: player state (Mixed) or enemy (Minimal)
+   const FString TargetName = ProbedActor.IsValid() ? ProbedActor->GetClass()->GetName() : TEXT("None");
+   const AActor* ASCOwner = ProbedASC.IsValid() ? ProbedASC->GetOwnerActor() : nullptr;
+   const FString ASCOwnerName = ASCOwner ? GetNameSafe(ASCOwner->GetClass()) : TEXT("None");
+
+   AuraNetLatencyProbe::LogSamples(TEXT("OnRep_Health"), TargetName, ASCOwnerName, Samples, LostSamples);
+   if (bProbedOverlay)
+   {
+      AuraNetLatencyProbe::LogSamples(TEXT("overlay OnHealthChanged"), TargetName, ASCOwnerName, OverlaySamples, LostOverlaySamples);
+   }
+
+   ProbedASC.Reset();
+   ProbedActor.Reset();
+   SamplesRemaining = 0;
+   bAwaitingSample = false;
+   bAwaitingOverlaySample = false;
+}
+
+void UAuraNetLatencyProbeComponent::StopListening()
+{
+   if (ProbedASC.IsValid())
+   {
+      ProbedASC->GetGameplayAttributeValueChangeDelegate(UAuraAttributeSet::GetHealthAttribute()).Remove(HealthChangedHandle);
+   }
+   if (ProbedOverlayController.IsValid())
+   {
+      ProbedOverlayController->OnHealthChanged.RemoveDynamic(this, &UAuraNetLatencyProbeComponent::OnOverlayHealthChanged);
+   }
+   ProbedOverlayController.Reset();
+
+   // Regeneration goes back to normal on the server
+   if (ProbedActor.IsValid())
+   {
+      ServerSetProbeActive(ProbedActor.Get(), false);
+   }
+}
+
+void UAuraNetLatencyProbeComponent::ServerApplyProbeEffect_Implementation(AActor* Target, int32 InSampleIndex)
+{
+#if UE_BUILD_SHIPPING
+   // Debug only: we don't want clients to be able to change attributes in a shipped game
+   return;
+#else
+   UAbilitySystemComponent* TargetASC = UAbilitySystemBlueprintLibrary::GetAbilitySystemComponent(Target);
+   if (TargetASC == nullptr || ProbeEffectClass == nullptr)
+   {
+      UE_LOG(LogAura, Warning, TEXT("Latency probe: missing target ASC or ProbeEffectClass"));
+      return;
+   }
+
+   FGameplayEffectContextHandle ContextHandle = TargetASC->MakeEffectContext();
+   ContextHandle.AddSourceObject(GetOwner());
+   const FGameplayEffectSpecHandle SpecHandle = TargetASC->MakeOutgoingSpec(ProbeEffectClass, 1.f, ContextHandle);
+   // Alternate so the value always changes and ends up where it started
+   SpecHandle.Data->SetSetByCallerMagnitude(FName("LatencyProbe"), GetProbeMagnitude(InSampleIndex));
+
+   // Executed in this frame: the application queue would add a server frame to every sample
+   if (UAuraAbilitySystemComponent* AuraASC = Cast<UAuraAbilitySystemComponent>(TargetASC))
+   {
+      AuraASC->ApplyGameplayEffectSpecToSelfUnqueued(*SpecHandle.Data.Get());
+   }
+   else
+   {
+      TargetASC->ApplyGameplayEffectSpecToSelf(*SpecHandle.Data.Get());
+   }
+#endif
+}
+
+void UAuraNetLatencyProbeComponent::ServerSetProbeActive_Implementation(AActor* Target, bool bActive)
+{
+#if !UE_BUILD_SHIPPING
+   // With regeneration running, Health sits at MaxHealth and the +1 steps would be clamped away
+   const UAbilitySystemComponent* TargetASC = UAbilitySystemBlueprintLibrary::GetAbilitySystemComponent(Target);
+   if (UAuraRegenerationSubsystem* RegenerationSubsystem = UWorld::GetSubsystem<UAuraRegenerationSubsystem>(GetWorld()))
+   {
+      RegenerationSubsystem->SetRegenerationSuspended(TargetASC, bActive);
+   }
+#endif
+}
@@ -0,0 +1,314 @@
+// Copyright Eveline Gomes.
+
+
+#include "Net/AuraReplicationGraph.h"
+
+/** Built-in graph nodes */
+#include "ReplicationGraphTypes.h"
+#include "Engine/NetDriver.h"
+#include "Engine/LevelScriptActor.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+
+/** Aura classes to route */
+#include "Actor/AuraEffectActor.h"
+#include "Character/AuraCharacter.h"
+#include "Character/AuraEnemy.h"
+#include "Player/AuraPlayerState.h"
+
+/** Load test */
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "AuraLogChannels.h"
+
+/** Attribute net profiler */
+#include "AbilitySystem/AuraAttributeSet.h"
+#include "Net/AuraAttributeNetProfiler.h"
+#include "UObject/UObjectIterator.h"
+
+namespace AuraReplicationGraph
+{
+   static FAutoConsoleCommandWithWorldAndArgs LoadTestCommand(
+      TEXT("Aura.RepGraph.LoadTest"),
+      TEXT("Server only. Aura.RepGraph.LoadTest <NumEnemies> [NumFrames = 300] [Spacing = 500]: spawn enemies, time the replication graph for ")
+      TEXT("NumFrames frames and log the node counts and cost."),
+      FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+      {
+         UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+         UAuraReplicationGraph* Graph = NetDriver && NetDriver->IsServer() ? Cast<UAuraReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr;
+         if (Graph == nullptr)
+         {
+            UE_LOG(LogAura, Warning, TEXT("Aura.RepGraph.LoadTest: run it on a server using UAuraReplicationGraph"));
+            return;
+         }
+
+         const int32 NumEnemies = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100;
+         const int32 NumFrames = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 300;
+         const float Spacing = Args.Num() > 2 ? FCString::Atof(*Args[2]) : 500.f;
+         Graph->StartLoadTest(FMath::Max(NumEnemies, 0), FMath::Max(NumFrames, 1), FMath::Max(Spacing, 100.f));
+      }));
+}
+
+UAuraReplicationGraph::UAuraReplicationGraph()
+{
+}
+
+void UAuraReplicationGraph::InitGlobalActorClassSettings()
+{
+   Super::InitGlobalActorClassSettings();
+
+   /**
+   * Explicit routing for the classes we know about. Anything else falls back to GetDefaultMappingPolicy() the first time one of its actors is
+   *  added to the graph.
+   */
+   ClassRepNodePolicies.Set(AAuraEnemy::StaticClass(), EAuraClassRepNodeMapping::Spatialize_Dynamic);
+   // Effect actors are placed in the level and don't move, so their grid cell only needs to be computed once
+   ClassRepNodePolicies.Set(AAuraEffectActor::StaticClass(), EAuraClassRepNodeMapping::Spatialize_Static);
+   ClassRepNodePolicies.Set(AAuraCharacter::StaticClass(), bSpatializePlayerPawns ? EAuraClassRepNodeMapping::Spatialize_Dynamic : EAuraClassRepNodeMapping::RelevantAllConnections);
+   ClassRepNodePolicies.Set(AAuraPlayerState::StaticClass(), EAuraClassRepNodeMapping::RelevantAllConnections);
+   ClassRepNodePolicies.Set(AGameStateBase::StaticClass(), EAuraClassRepNodeMapping::RelevantAllConnections);
+   // Owner only: picked up by the connection node (which replicates the connection's viewer and view target)
+   ClassRepNodePolicies.Set(APlayerController::StaticClass(), EAuraClassRepNodeMapping::NotRouted);
+   ClassRepNodePolicies.Set(ALevelScriptActor::StaticClass(), EAuraClassRepNodeMapping::NotRouted);
+
+   /**
+   * Fill the class replication info (cull distance and how many frames between replications) from each replicated native class CDO. BP classes
+   *  that aren't loaded yet will use the info of their closest native parent, which is what the lookup in GlobalActorReplicationInfoMap does.
+   */
+   const float ServerMaxTickRate = NetDriver ? static_cast<float>(NetDriver->NetServerMaxTickRate) : 30.f;
+   for (TObjectIterator<UClass> It; It; ++It)
+   {
+      UClass* Class = *It;
+      const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject(false));
+      if (ActorCDO == nullptr || !ActorCDO->GetIsReplicated()) continue;
+      if (Class->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated | CLASS_NewerVersionExists)) continue;
+      if (Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_"))) continue;
+
+      const EAuraClassRepNodeMapping Policy = GetMappingPolicy(Class);
+      const bool bSpatialized = Policy == EAuraClassRepNodeMapping::Spatialize_Static
+         || Policy == EAuraClassRepNodeMapping::Spatialize_Dynamic
+         || Policy == EAuraClassRepNodeMapping::Spatialize_Dormancy;
+
+      FClassReplicationInfo ClassInfo;
+      // Only spatialized actors are culled by distance, the others are relevant no matter where the viewer is
+      if (bSpatialized)
+      {
+         ClassInfo.SetCullDistanceSquared(ActorCDO->NetCullDistanceSquared);
+      }
+      ClassInfo.ReplicationPeriodFrame = FMath::Max<uint32>(FMath::RoundToInt(ServerMaxTickRate / FMath::Max(ActorCDO->NetUpdateFrequency, 1.f)), 1);
+      GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+   }
+
+   DestructInfoMaxDistanceSquared = DestructionInfoMaxDist * DestructionInfoMaxDist;
+}
+
+void UAuraReplicationGraph::InitGlobalGraphNodes()
+{
+   // Enemies, effect actors and pawns
+   GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+   GridNode->CellSize = GridCellSize;
+   GridNode->SpatialBias = FVector2D(SpatialBiasX, SpatialBiasY);
+   AddGlobalGraphNode(GridNode);
+
+   // Player states: they own the ASC and AttributeSet of each player, so they go into their own list instead of being mixed with everything else
+   PlayerStateNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+   AddGlobalGraphNode(PlayerStateNode);
+
+   // Game state and other global actors
+   AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+   AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UAuraReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+   Super::InitConnectionGraphNodes(RepGraphConnection);
+
+   // Owner only data: this node replicates the connection's player controller and view target to that connection only
+   UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+   AddConnectionGraphNode(ConnectionNode, RepGraphConnection);
+}
+
+void UAuraReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+   switch (GetMappingPolicy(ActorInfo.Class))
+   {
+   case EAuraClassRepNodeMapping::RelevantAllConnections:
+      if (ActorInfo.Actor->IsA<APlayerState>())
+      {
+         PlayerStateNode->NotifyAddNetworkActor(ActorInfo);
+      }
+      else
+      {
+         AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+      }
+      break;
+   case EAuraClassRepNodeMapping::Spatialize_Static:
+      GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+      break;
+   case EAuraClassRepNodeMapping::Spatialize_Dynamic:
+      GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+      break;
+   case EAuraClassRepNodeMapping::Spatialize_Dormancy:
+      GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+      break;
+   case EAuraClassRepNodeMapping::NotRouted:
+   default:
+      break;
+   }
+}
+
+void UAuraReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+   switch (GetMappingPolicy(ActorInfo.Class))
+   {
+   case EAuraClassRepNodeMapping::RelevantAllConnections:
+      if (ActorInfo.Actor->IsA<APlayerState>())
+      {
+         PlayerStateNode->NotifyRemoveNetworkActor(ActorInfo);
+      }
+      else
+      {
+         AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+      }
+      break;
+   case EAuraClassRepNodeMapping::Spatialize_Static:
+      GridNode->RemoveActor_Static(ActorInfo);
+      break;
+   case EAuraClassRepNodeMapping::Spatialize_Dynamic:
+      GridNode->RemoveActor_Dynamic(ActorInfo);
+      break;
+   case EAuraClassRepNodeMapping::Spatialize_Dormancy:
+      GridNode->RemoveActor_Dormancy(ActorInfo);
+      break;
+   case EAuraClassRepNodeMapping::NotRouted:
+   default:
+      break;
+   }
+}
+
+int32 UAuraReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+   const bool bTimingLoadTest = LoadTest.FramesRemaining > 0;
+   const double StartTime = bTimingLoadTest ? FPlatformTime::Seconds() : 0.0;
+   const int32 Result = Super::ServerReplicateActors(DeltaSeconds);
+
+   if (bTimingLoadTest)
+   {
+      const double Elapsed = FPlatformTime::Seconds() - StartTime;
+      LoadTest.TotalSeconds += Elapsed;
+      LoadTest.MaxSeconds = FMath::Max(LoadTest.MaxSeconds, Elapsed);
+      if (--LoadTest.FramesRemaining == 0)
+      {
+         FinishLoadTest();
+      }
+   }
+
+   if (FAuraAttributeNetProfiler::Get().IsRunning())
+   {
+      RecordReplicatedAttributes();
+   }
+   return Result;
+}
+
+void UAuraReplicationGraph::RecordReplicatedAttributes()
+{
+   const UWorld* World = NetDriver ? NetDriver->GetWorld() : nullptr;
+   FAuraAttributeNetProfiler& Profiler = FAuraAttributeNetProfiler::Get();
+
+   for (TObjectIterator<UAuraAttributeSet> It; It; ++It)
+   {
+      AActor* OwningActor = It->GetWorld() == World ? It->GetOwningActor() : nullptr;
+      if (OwningActor == nullptr) continue;
+
+      // LastRepFrameNum moves whenever the actor is replicated to that connection, so the profiler can tell a new replication from an old one
+      for (UNetReplicationGraphConnection* Connection : Connections)
+      {
+         const FConnectionReplicationActorInfo* ActorInfo = Connection ? Connection->ActorInfoMap.Find(OwningActor) : nullptr;
+         if (ActorInfo && ActorInfo->Channel)
+         {
+            Profiler.RecordReplicatedActor(Connection->NetConnection, *It, ActorInfo->LastRepFrameNum);
+         }
+      }
+   }
+}
+
+void UAuraReplicationGraph::StartLoadTest(int32 NumEnemies, int32 NumFrames, float Spacing)
+{
+   UWorld* World = NetDriver ? NetDriver->GetWorld() : nullptr;
+   if (World == nullptr || LoadTest.FramesRemaining > 0) return;
+
+   UClass* EnemyClass = LoadTestEnemyClass.IsNull() ? AAuraEnemy::StaticClass() : LoadTestEnemyClass.LoadSynchronous();
+   if (EnemyClass == nullptr) return;
+
+   // A square around the first player, so some of the enemies are in the cells its connection gathers and some aren't
+   const APlayerController* FirstPlayer = World->GetFirstPlayerController();
+   const FVector Center = FirstPlayer && FirstPlayer->GetPawn() ? FirstPlayer->GetPawn()->GetActorLocation() : FVector::ZeroVector;
+   const int32 SideCount = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumEnemies)));
+
+   FActorSpawnParameters SpawnParameters;
+   SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+   LoadTest = FLoadTest();
+   LoadTest.Enemies.Reserve(NumEnemies);
+   for (int32 Index = 0; Index < NumEnemies; ++Index)
+   {
+      const FVector Offset((Index % SideCount - SideCount / 2) * Spacing, (Index / SideCount - SideCount / 2) * Spacing, 0.f);
+      LoadTest.Enemies.Add(World->SpawnActor<AActor>(EnemyClass, Center + Offset, FRotator::ZeroRotator, SpawnParameters));
+   }
+   LoadTest.NumFrames = NumFrames;
+   LoadTest.FramesRemaining = NumFrames;
+
+   UE_LOG(LogAura, Display, TEXT("Replication graph load test: %d %s spawned, timing %d frames over %d connections"),
+      NumEnemies, *EnemyClass->GetName(), NumFrames, Connections.Num());
+}
+
+void UAuraReplicationGraph::FinishLoadTest()
+{
+   TArray<FActorRepListType> NodeActors;
+   auto CountActors = [&NodeActors](const UReplicationGraphNode* Node)
+   {
+      NodeActors.Reset();
+      if (Node) Node->GetAllActorsInNode_Debugging(NodeActors);
+      return NodeActors.Num();
+   };
+
+   UE_LOG(LogAura, Display, TEXT("Replication graph load test: %d connections, %d enemies | grid %d, player states %d, always relevant %d actors | ")
+      TEXT("ServerReplicateActors avg %.3f ms, max %.3f ms over %d frames"),
+      Connections.Num(), LoadTest.Enemies.Num(), CountActors(GridNode), CountActors(PlayerStateNode), CountActors(AlwaysRelevantNode),
+      LoadTest.TotalSeconds / LoadTest.NumFrames * 1000.0, LoadTest.MaxSeconds * 1000.0, LoadTest.NumFrames);
+
+   for (const TWeakObjectPtr<AActor>& Enemy : LoadTest.Enemies)
+   {
+      if (Enemy.IsValid())
+      {
+         Enemy->Destroy();
+      }
+   }
+   LoadTest = FLoadTest();
+}
+
+EAuraClassRepNodeMapping UAuraReplicationGraph::GetMappingPolicy(UClass* Class)
+{
+   if (const EAuraClassRepNodeMapping* Policy = ClassRepNodePolicies.Get(Class))
+   {
+      return *Policy;
+   }
+
+   // First time we see this class (and none of its parents were mapped): work it out from the CDO and cache it
+   const EAuraClassRepNodeMapping Policy = GetDefaultMappingPolicy(Cast<AActor>(Class->GetDefaultObject()));
+   ClassRepNodePolicies.Set(Class, Policy);
+   return Policy;
+}
+
+EAuraClassRepNodeMapping UAuraReplicationGraph::GetDefaultMappingPolicy(const AActor* ActorCDO) const
+{
+   if (ActorCDO == nullptr) return EAuraClassRepNodeMapping::NotRouted;
+
+   if (ActorCDO->bOnlyRelevantToOwner) return EAuraClassRepNodeMapping::NotRouted;
+   if (ActorCDO->bAlwaysRelevant) return EAuraClassRepNodeMapping::RelevantAllConnections;
+   if (ActorCDO->NetDormancy > DORM_Awake) return EAuraClassRepNodeMapping::Spatialize_Dormancy;
+   if (ActorCDO->IsReplicatingMovement()) return EAuraClassRepNodeMapping::Spatialize_Dynamic;
+
+   return EAuraClassRepNodeMapping::Spatialize_Static;
+}
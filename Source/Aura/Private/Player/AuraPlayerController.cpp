@@ -10,10 +10,22 @@
 /** Interfaces */
 #include "Interaction/EnemyInterface.h"
 
+/** Gameplay tags dictionary validation */
+#include "GameplayTagsManager.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/GameSession.h"
+#include "AuraLogChannels.h"
+
+/** Debug */
+#include "Net/AuraNetLatencyProbeComponent.h"
+#include "AuraStats.h"
+
 AAuraPlayerController::AAuraPlayerController()
 {
    /** Changes will be sent to all clients in the same server. It'll be addressed better later.*/
    bReplicates = true;
+
+   LatencyProbe = CreateDefaultSubobject<UAuraNetLatencyProbeComponent>("LatencyProbe");
 }
 
 void AAuraPlayerController::PlayerTick(float DeltaTime)
@@ -29,6 +41,18 @@ void AAuraPlayerController::PlayerTick(float DeltaTime)
 
 }
 
+void AAuraPlayerController::AuraProbeLatency(int32 NumSamples, bool bTargetEnemy)
+{
+   AActor* Target = bTargetEnemy ? Cast<AActor>(ThisActor.GetObject()) : GetPawn();
+   if (Target == nullptr)
+   {
+      UE_LOG(LogAura, Warning, TEXT("AuraProbeLatency: no target (hover over an enemy, or possess a pawn)"));
+      return;
+   }
+
+   LatencyProbe->StartProbe(NumSamples, Target);
+}
+
 void AAuraPlayerController::BeginPlay()
 {
    Super::BeginPlay();
@@ -83,6 +107,12 @@ void AAuraPlayerController::BeginPlay()
    InputModeData.SetHideCursorDuringCapture(false); // won't hide the cursor as soons as it's captured into the viewport
    // Now, in order to use this InputModeData, use a player controller function to set it:
    SetInputMode(InputModeData);  
+
+   // Only a remote client can have a different tag dictionary than the server
+   if (IsLocalController() && !HasAuthority())
+   {
+      ValidateGameplayTagNetIndex();
+   }
 }
 
 void AAuraPlayerController::SetupInputComponent()
@@ -164,6 +194,7 @@ void AAuraPlayerController::Move(const FInputActionValue& InputActionValue)
 
 void AAuraPlayerController::CursorTrace()
 {
+   TRACE_CPUPROFILER_EVENT_SCOPE(AAuraPlayerController::CursorTrace);
 
    /** 
    * Get the hit result under the cursor. This is something that the PlayerController class inheritly has the ability to do.
@@ -235,4 +266,32 @@ void AAuraPlayerController::CursorTrace()
          }
       }
    }
-}
\ No newline at end of file
+}
+
+void AAuraPlayerController::ValidateGameplayTagNetIndex()
+{
+   const UGameplayTagsManager& TagsManager = UGameplayTagsManager::Get();
+   if (!TagsManager.ShouldUseFastReplication()) return;
+
+   ServerReportGameplayTagNetIndexHash(TagsManager.GetNetworkGameplayTagNodeIndexHash());
+}
+
+void AAuraPlayerController::ServerReportGameplayTagNetIndexHash_Implementation(uint32 ClientHash)
+{
+   const uint32 ServerHash = UGameplayTagsManager::Get().GetNetworkGameplayTagNodeIndexHash();
+   if (ClientHash == ServerHash) return;
+
+   /** 
+   * The dictionaries don't match, so every tag this client sends or receives could be wrong. That's a build mismatch (different tag ini or tag
+   *  tables), not something the client can recover from, so we kick it.
+   */
+   UE_LOG(LogAura, Error, TEXT("Gameplay tag net index mismatch for %s: client hash %u, server hash %u. Kicking the player."), *GetNameSafe(this), ClientHash, ServerHash);
+
+   if (const AGameModeBase* GameMode = GetWorld()->GetAuthGameMode())
+   {
+      if (GameMode->GameSession)
+      {
+         GameMode->GameSession->KickPlayer(this, NSLOCTEXT("Aura", "TagDictionaryMismatch", "Client and server gameplay tags don't match. Please update your game."));
+      }
+   }
+}
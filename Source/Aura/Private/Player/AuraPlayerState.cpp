@@ -10,13 +10,25 @@
 #include "AbilitySystem/AuraAbilitySystemComponent.h"
 #include "AbilitySystem/AuraAttributeSet.h"
 
+/** Progression snapshots */
+#include "Save/AuraAbilitySystemSnapshot.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "AuraLogChannels.h"
+
+/** Memory tracking */
+#include "AuraMemoryTracking.h"
+
 AAuraPlayerState::AAuraPlayerState()
 {
    /** 
    * Construct GAS related pointers:
    */
    // Construct AuraAbilitySystemComponent
-   AbilitySystemComponent = CreateDefaultSubobject<UAuraAbilitySystemComponent>("AbilitySystemComponent");
+   {
+      LLM_SCOPE_BYTAG(Aura_AbilitySystem);
+      AbilitySystemComponent = CreateDefaultSubobject<UAuraAbilitySystemComponent>("AbilitySystemComponent");
+   }
    // Make sure it is replicated
    AbilitySystemComponent->SetIsReplicated(true);
    /** 
@@ -32,7 +44,10 @@ AAuraPlayerState::AAuraPlayerState()
    AbilitySystemComponent->SetReplicationMode(EGameplayEffectReplicationMode::Mixed);
 
    // Construct AttributeSet
-   AttributeSet = CreateDefaultSubobject<UAuraAttributeSet>("AttributeSet");
+   {
+      LLM_SCOPE_BYTAG(Aura_AttributeSets);
+      AttributeSet = CreateDefaultSubobject<UAuraAttributeSet>("AttributeSet");
+   }
 
    /** 
    * Use NetUpdateFrequency to set how often the server tries to update clients. That's useful to sync up clients with the server version 
@@ -56,7 +71,89 @@ UAbilitySystemComponent* AAuraPlayerState::GetAbilitySystemComponent() const
    return AbilitySystemComponent;
 }
 
+void AAuraPlayerState::SetLevel(int32 InLevel)
+{
+   if (!HasAuthority() || InLevel == Level) return;
+
+   Level = InLevel;
+   HandleLevelChanged();
+}
+
+void AAuraPlayerState::SaveSnapshot(const FString& SlotName) const
+{
+   if (!HasAuthority() || AbilitySystemComponent == nullptr) return;
+
+   TArray<uint8> Bytes;
+   AuraSnapshot::Capture(*AbilitySystemComponent, Level, Bytes);
+   AuraSnapshot::WriteSnapshotAsync(MoveTemp(Bytes), SlotName);
+}
+
+bool AAuraPlayerState::LoadSnapshot(const FString& SlotName)
+{
+   if (!HasAuthority()) return false;
+
+   // A quick logout and login: the snapshot or journal delete queued by the logout has to land before we read the slot
+   AuraSnapshot::WaitForPendingWrites();
+
+   const FString FilePath = AuraSnapshot::GetSlotPath(SlotName);
+   if (!IFileManager::Get().FileExists(*FilePath)) return false;
+
+   /**
+   * The mapping is released as soon as the file is validated: the pending copy waits for the avatar, and a save replacing the file in the
+   *  meantime (a move onto a mapped file fails on Windows) isn't blocked by it.
+   */
+   {
+      FAuraSnapshotFile SnapshotFile;
+      FAuraSnapshotView View;
+      if (!SnapshotFile.Open(FilePath) || !AuraSnapshot::Parse(SnapshotFile.GetBytes(), View))
+      {
+         UE_LOG(LogAura, Warning, TEXT("Snapshot %s couldn't be read, %s starts from the default attributes"), *FilePath, *GetPlayerName());
+         return false;
+      }
+      const TConstArrayView<uint8> Bytes = SnapshotFile.GetBytes();
+      PendingSnapshot.Reset(Bytes.Num());
+      PendingSnapshot.Append(Bytes.GetData(), Bytes.Num());
+   }
+
+   // Changes saved by the autosave since that snapshot (small, no need to map it)
+   PendingJournal.Reset();
+   FFileHelper::LoadFileToArray(PendingJournal, *AuraSnapshot::GetJournalPath(SlotName), FILEREAD_Silent);
+   return true;
+}
+
+bool AAuraPlayerState::RestorePendingSnapshot()
+{
+   if (PendingSnapshot.IsEmpty() || AbilitySystemComponent == nullptr) return false;
+
+   // Restored once: a later respawn goes through the ASC state we have from now on
+   const TArray<uint8> SnapshotBytes = MoveTemp(PendingSnapshot);
+
+   FAuraSnapshotView View;
+   if (!AuraSnapshot::Parse(SnapshotBytes, View)) return false;
+
+   // Level first: the restored effects cache it in their context when they're made
+   SetLevel(View.Header->Level);
+   if (!AuraSnapshot::Restore(*AbilitySystemComponent, View)) return false;
+
+   int32 JournalLevel = Level;
+   AuraSnapshot::ReplayJournal(*AbilitySystemComponent, PendingJournal, JournalLevel);
+   SetLevel(JournalLevel);
+   PendingJournal.Empty();
+   return true;
+}
+
 void AAuraPlayerState::OnRep_Level(int32 OldLevel)
 {
+   HandleLevelChanged();
+}
+
+void AAuraPlayerState::HandleLevelChanged()
+{
+   // Only does something on the server, where the active effects are; clients get the new magnitudes through attribute replication
+   if (UAuraAbilitySystemComponent* AuraASC = Cast<UAuraAbilitySystemComponent>(AbilitySystemComponent))
+   {
+      AuraASC->SetCombatLevel(Level);
+   }
 
+   OnLevelChangedDelegate.Broadcast(Level);
 }
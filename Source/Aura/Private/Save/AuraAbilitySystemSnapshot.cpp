@@ -0,0 +1,323 @@
+// Copyright Eveline Gomes.
+
+
+#include "Save/AuraAbilitySystemSnapshot.h"
+
+/** GAS */
+#include "AbilitySystemComponent.h"
+#include "AbilitySystem/AuraAbilityTypes.h"
+#include "AbilitySystem/AuraAttributeSet.h"
+#include "Engine/World.h"
+
+/** Files */
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Tasks/Pipe.h"
+
+#include "AuraLogChannels.h"
+
+namespace AuraSnapshot
+{
+   static_assert(sizeof(FAuraSnapshotHeader) % 4 == 0 && sizeof(FAuraSnapshotEffect) % 4 == 0, "Snapshot blocks have to stay 4 byte aligned");
+   static_assert(sizeof(FAuraJournalRecordHeader) % 4 == 0 && sizeof(FAuraJournalAttribute) % 4 == 0, "Journal records have to stay 4 byte aligned");
+   static_assert(PLATFORM_LITTLE_ENDIAN, "Snapshots are written and mapped as little endian");
+
+   /** Every snapshot write goes through this pipe, so two saves of the same slot can't interleave */
+   static UE::Tasks::FPipe WritePipe{ TEXT("AuraSnapshotWrite") };
+
+   /** Vital attributes are restored after the effects, once their max values are back */
+   static bool IsVitalAttribute(int32 Index)
+   {
+      return Index == static_cast<int32>(EAuraAttribute::Health) || Index == static_cast<int32>(EAuraAttribute::Mana);
+   }
+}
+
+FString FAuraSnapshotView::GetEffectClassPath(const FAuraSnapshotEffect& Effect) const
+{
+   return FString(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(Strings + Effect.ClassPathOffset), Effect.ClassPathLength));
+}
+
+void AuraSnapshot::Capture(const UAbilitySystemComponent& AbilitySystemComponent, int32 Level, TArray<uint8>& OutBytes)
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(AuraSnapshot::Capture);
+
+   FAuraAttributeSnapshot AttributeSnapshot;
+   if (const UAuraAttributeSet* AttributeSet = AbilitySystemComponent.GetSet<UAuraAttributeSet>())
+   {
+      AttributeSet->GetSnapshot(AttributeSnapshot, true);
+   }
+
+   /** Effects and their class paths */
+   TArray<FAuraSnapshotEffect, TInlineAllocator<16>> Effects;
+   TArray<UTF8CHAR> Strings;
+   const float WorldTime = AbilitySystemComponent.GetWorld() ? AbilitySystemComponent.GetWorld()->GetTimeSeconds() : 0.f;
+   for (const FActiveGameplayEffectHandle& Handle : AbilitySystemComponent.GetActiveEffects(FGameplayEffectQuery()))
+   {
+      const FActiveGameplayEffect* ActiveEffect = AbilitySystemComponent.GetActiveGameplayEffect(Handle);
+      if (ActiveEffect == nullptr || ActiveEffect->Spec.Def == nullptr) continue;
+
+      // Instigator == target isn't enough to tell: effect actors make their context from the target's ASC too
+      const bool bIsInfinite = ActiveEffect->GetDuration() == FGameplayEffectConstants::INFINITE_DURATION;
+      const FAuraGameplayEffectContext* AuraContext = FAuraGameplayEffectContext::Get(ActiveEffect->Spec.GetContext());
+      if (bIsInfinite && (AuraContext == nullptr || !AuraContext->IsAppliedToSelf())) continue;
+
+      const FTCHARToUTF8 ClassPath(*ActiveEffect->Spec.Def->GetClass()->GetPathName());
+
+      FAuraSnapshotEffect& Effect = Effects.AddDefaulted_GetRef();
+      Effect.ClassPathOffset = Strings.Num();
+      Effect.ClassPathLength = ClassPath.Length();
+      Effect.Level = ActiveEffect->Spec.GetLevel();
+      Effect.TimeRemaining = bIsInfinite ? -1.f : FMath::Max(ActiveEffect->GetTimeRemaining(WorldTime), 0.f);
+      Effect.StackCount = ActiveEffect->Spec.GetStackCount();
+      Strings.Append(reinterpret_cast<const UTF8CHAR*>(ClassPath.Get()), ClassPath.Length());
+   }
+
+   FAuraSnapshotHeader Header;
+   Header.NumAttributes = FAuraAttributeSnapshot::NumAttributes;
+   Header.NumEffects = Effects.Num();
+   Header.StringBytes = Align(Strings.Num(), 4);
+   Header.Level = Level;
+   Strings.SetNumZeroed(Header.StringBytes);
+
+   /** One allocation, then plain copies of each block */
+   const int32 AttributeBytes = sizeof(float) * Header.NumAttributes;
+   const int32 EffectBytes = sizeof(FAuraSnapshotEffect) * Header.NumEffects;
+   OutBytes.SetNumUninitialized(sizeof(FAuraSnapshotHeader) + AttributeBytes + EffectBytes + Header.StringBytes);
+
+   uint8* Write = OutBytes.GetData();
+   FMemory::Memcpy(Write, &Header, sizeof(FAuraSnapshotHeader));
+   Write += sizeof(FAuraSnapshotHeader);
+   FMemory::Memcpy(Write, AttributeSnapshot.Base, AttributeBytes);
+   Write += AttributeBytes;
+   FMemory::Memcpy(Write, Effects.GetData(), EffectBytes);
+   Write += EffectBytes;
+   FMemory::Memcpy(Write, Strings.GetData(), Header.StringBytes);
+}
+
+bool AuraSnapshot::Parse(TConstArrayView<uint8> Bytes, FAuraSnapshotView& OutView)
+{
+   OutView = FAuraSnapshotView();
+   if (Bytes.Num() < static_cast<int32>(sizeof(FAuraSnapshotHeader)) || !IsAligned(Bytes.GetData(), 4)) return false;
+
+   const FAuraSnapshotHeader* Header = reinterpret_cast<const FAuraSnapshotHeader*>(Bytes.GetData());
+   if (Header->Magic != FAuraSnapshotHeader::ExpectedMagic || Header->Version != FAuraSnapshotHeader::CurrentVersion)
+   {
+      UE_LOG(LogAura, Warning, TEXT("Snapshot: unknown magic or version %d (expected %d)"), Header->Version, FAuraSnapshotHeader::CurrentVersion);
+      return false;
+   }
+   if (Header->NumAttributes != FAuraAttributeSnapshot::NumAttributes || Header->StringBytes % 4 != 0) return false;
+
+   const int64 AttributeBytes = sizeof(float) * static_cast<int64>(Header->NumAttributes);
+   const int64 EffectBytes = sizeof(FAuraSnapshotEffect) * static_cast<int64>(Header->NumEffects);
+   if (sizeof(FAuraSnapshotHeader) + AttributeBytes + EffectBytes + Header->StringBytes != Bytes.Num()) return false;
+
+   const uint8* Read = Bytes.GetData() + sizeof(FAuraSnapshotHeader);
+   OutView.Header = Header;
+   OutView.AttributeBase = reinterpret_cast<const float*>(Read);
+   OutView.Effects = reinterpret_cast<const FAuraSnapshotEffect*>(Read + AttributeBytes);
+   OutView.Strings = reinterpret_cast<const UTF8CHAR*>(Read + AttributeBytes + EffectBytes);
+
+   // Every class path has to be inside the string block
+   for (uint32 Index = 0; Index < Header->NumEffects; ++Index)
+   {
+      const FAuraSnapshotEffect& Effect = OutView.Effects[Index];
+      if (static_cast<uint64>(Effect.ClassPathOffset) + Effect.ClassPathLength > Header->StringBytes)
+      {
+         OutView = FAuraSnapshotView();
+         return false;
+      }
+   }
+   return true;
+}
+
+bool AuraSnapshot::Restore(UAbilitySystemComponent& AbilitySystemComponent, const FAuraSnapshotView& View)
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(AuraSnapshot::Restore);
+
+   if (View.Header == nullptr || AbilitySystemComponent.GetSet<UAuraAttributeSet>() == nullptr) return false;
+
+   for (int32 Index = 0; Index < View.Header->NumAttributes; ++Index)
+   {
+      if (IsVitalAttribute(Index)) continue;
+      AbilitySystemComponent.SetNumericAttributeBase(UAuraAttributeSet::GetAttribute(static_cast<EAuraAttribute>(Index)), View.AttributeBase[Index]);
+   }
+
+   // One context for all of them: the effects come back as applied by the ASC's avatar, like the default attribute effects
+   FGameplayEffectContextHandle ContextHandle = AbilitySystemComponent.MakeEffectContext();
+   ContextHandle.AddSourceObject(AbilitySystemComponent.GetAvatarActor());
+   if (FAuraGameplayEffectContext* AuraContext = FAuraGameplayEffectContext::GetMutable(ContextHandle))
+   {
+      AuraContext->SetAppliedToSelf(true);
+   }
+   for (uint32 Index = 0; Index < View.Header->NumEffects; ++Index)
+   {
+      const FAuraSnapshotEffect& Effect = View.Effects[Index];
+      const FString ClassPath = View.GetEffectClassPath(Effect);
+      const TSubclassOf<UGameplayEffect> EffectClass = FSoftClassPath(ClassPath).TryLoadClass<UGameplayEffect>();
+      if (EffectClass == nullptr)
+      {
+         UE_LOG(LogAura, Warning, TEXT("Snapshot: effect class %s not found, skipped"), *ClassPath);
+         continue;
+      }
+
+      const FGameplayEffectSpecHandle SpecHandle = AbilitySystemComponent.MakeOutgoingSpec(EffectClass, Effect.Level, ContextHandle);
+      SpecHandle.Data->SetStackCount(FMath::Max(Effect.StackCount, 1));
+      if (Effect.TimeRemaining > 0.f)
+      {
+         SpecHandle.Data->SetDuration(Effect.TimeRemaining, true);
+      }
+      AbilitySystemComponent.ApplyGameplayEffectSpecToSelf(*SpecHandle.Data.Get());
+   }
+
+   for (int32 Index = 0; Index < View.Header->NumAttributes; ++Index)
+   {
+      if (!IsVitalAttribute(Index)) continue;
+      AbilitySystemComponent.SetNumericAttributeBase(UAuraAttributeSet::GetAttribute(static_cast<EAuraAttribute>(Index)), View.AttributeBase[Index]);
+   }
+   return true;
+}
+
+void AuraSnapshot::ReplayJournal(UAbilitySystemComponent& AbilitySystemComponent, TConstArrayView<uint8> JournalBytes, int32& OutLevel)
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(AuraSnapshot::ReplayJournal);
+
+   // Later records win: keep the last value of each attribute, and write them once at the end
+   float BaseValues[FAuraAttributeSnapshot::NumAttributes];
+   bool bChanged[FAuraAttributeSnapshot::NumAttributes] = {};
+
+   int64 Offset = 0;
+   while (Offset + static_cast<int64>(sizeof(FAuraJournalRecordHeader)) <= JournalBytes.Num())
+   {
+      FAuraJournalRecordHeader Header;
+      FMemory::Memcpy(&Header, JournalBytes.GetData() + Offset, sizeof(FAuraJournalRecordHeader));
+      if (Header.Magic != FAuraJournalRecordHeader::ExpectedMagic || Header.Version != FAuraJournalRecordHeader::CurrentVersion) break;
+
+      const int64 EntriesBytes = sizeof(FAuraJournalAttribute) * static_cast<int64>(Header.NumAttributes);
+      if (Offset + static_cast<int64>(sizeof(FAuraJournalRecordHeader)) + EntriesBytes > JournalBytes.Num()) break;
+      Offset += sizeof(FAuraJournalRecordHeader);
+
+      for (int32 Entry = 0; Entry < Header.NumAttributes; ++Entry)
+      {
+         FAuraJournalAttribute Attribute;
+         FMemory::Memcpy(&Attribute, JournalBytes.GetData() + Offset, sizeof(FAuraJournalAttribute));
+         Offset += sizeof(FAuraJournalAttribute);
+
+         if (Attribute.Index < FAuraAttributeSnapshot::NumAttributes)
+         {
+            BaseValues[Attribute.Index] = Attribute.BaseValue;
+            bChanged[Attribute.Index] = true;
+         }
+      }
+      OutLevel = Header.Level;
+   }
+
+   for (int32 Index = 0; Index < FAuraAttributeSnapshot::NumAttributes; ++Index)
+   {
+      if (bChanged[Index])
+      {
+         AbilitySystemComponent.SetNumericAttributeBase(UAuraAttributeSet::GetAttribute(static_cast<EAuraAttribute>(Index)), BaseValues[Index]);
+      }
+   }
+}
+
+void AuraSnapshot::WriteJournalRecord(int32 Level, TConstArrayView<FAuraJournalAttribute> Attributes, TArray<uint8>& OutBytes)
+{
+   FAuraJournalRecordHeader Header;
+   Header.NumAttributes = Attributes.Num();
+   Header.Level = Level;
+
+   OutBytes.Append(reinterpret_cast<const uint8*>(&Header), sizeof(FAuraJournalRecordHeader));
+   OutBytes.Append(reinterpret_cast<const uint8*>(Attributes.GetData()), sizeof(FAuraJournalAttribute) * Attributes.Num());
+}
+
+void AuraSnapshot::WriteSnapshotAsync(TArray<uint8>&& Bytes, const FString& SlotName)
+{
+   WritePipe.Launch(TEXT("AuraSnapshotWrite"), [Bytes = MoveTemp(Bytes), FilePath = GetSlotPath(SlotName), JournalPath = GetJournalPath(SlotName)]()
+   {
+      TRACE_CPUPROFILER_EVENT_SCOPE(AuraSnapshot::WriteSnapshot);
+
+      // Write next to it and swap, so a crash in the middle of a save leaves the previous snapshot intact
+      const FString TempPath = FilePath + TEXT(".tmp");
+      if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) || !IFileManager::Get().Move(*FilePath, *TempPath, true))
+      {
+         UE_LOG(LogAura, Error, TEXT("Snapshot: couldn't write %s"), *FilePath);
+         return;
+      }
+      // Only once the new snapshot is in place: until then the old snapshot + journal is the latest state
+      IFileManager::Get().Delete(*JournalPath, false, false, true);
+   });
+}
+
+void AuraSnapshot::WaitForPendingWrites()
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(AuraSnapshot::WaitForPendingWrites);
+
+   if (WritePipe.HasWork())
+   {
+      WritePipe.WaitUntilEmpty();
+   }
+}
+
+void AuraSnapshot::AppendJournalAsync(TArray<uint8>&& Bytes, const FString& SlotName)
+{
+   WritePipe.Launch(TEXT("AuraJournalAppend"), [Bytes = MoveTemp(Bytes), JournalPath = GetJournalPath(SlotName)]()
+   {
+      TRACE_CPUPROFILER_EVENT_SCOPE(AuraSnapshot::AppendJournal);
+
+      if (!FFileHelper::SaveArrayToFile(Bytes, *JournalPath, &IFileManager::Get(), FILEWRITE_Append))
+      {
+         UE_LOG(LogAura, Error, TEXT("Snapshot: couldn't append to %s"), *JournalPath);
+      }
+   });
+}
+
+FString AuraSnapshot::GetSlotPath(const FString& SlotName)
+{
+   return FPaths::ProjectSavedDir() / TEXT("SaveGames") / TEXT("Aura") / (SlotName + TEXT(".aurasnap"));
+}
+
+FString AuraSnapshot::GetJournalPath(const FString& SlotName)
+{
+   return FPaths::ProjectSavedDir() / TEXT("SaveGames") / TEXT("Aura") / (SlotName + TEXT(".aurajournal"));
+}
+
+FAuraSnapshotFile::FAuraSnapshotFile() = default;
+
+FAuraSnapshotFile::~FAuraSnapshotFile()
+{
+   // The region has to go before the handle it was mapped from
+   MappedRegion.Reset();
+   MappedHandle.Reset();
+}
+
+bool FAuraSnapshotFile::Open(const FString& FilePath)
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(FAuraSnapshotFile::Open);
+
+   MappedRegion.Reset();
+   MappedHandle.Reset();
+   LoadedBytes.Reset();
+
+   MappedHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FilePath));
+   if (MappedHandle.IsValid() && MappedHandle->GetFileSize() > 0)
+   {
+      MappedRegion.Reset(MappedHandle->MapRegion(0, MappedHandle->GetFileSize()));
+      if (MappedRegion.IsValid()) return true;
+   }
+   MappedHandle.Reset();
+
+   // No memory mapping on this platform (or for this file): read it instead
+   return FFileHelper::LoadFileToArray(LoadedBytes, *FilePath, FILEREAD_Silent);
+}
+
+TConstArrayView<uint8> FAuraSnapshotFile::GetBytes() const
+{
+   if (MappedRegion.IsValid())
+   {
+      return TConstArrayView<uint8>(MappedRegion->GetMappedPtr(), static_cast<int32>(MappedRegion->GetMappedSize()));
+   }
+   return LoadedBytes;
+}
@@ -0,0 +1,259 @@
+// Copyright Eveline Gomes.
+
+
+#include "Save/AuraAutosaveSubsystem.h"
+
+#include "AbilitySystemComponent.h"
+#include "Player/AuraPlayerState.h"
+#include "Save/AuraAbilitySystemSnapshot.h"
+
+#include "AuraStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Autosave Checkpoint"), STAT_AuraAutosaveCheckpoint, STATGROUP_Aura);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Autosave Journal Records"), STAT_AuraAutosaveJournalRecords, STATGROUP_Aura);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Autosave Snapshots"), STAT_AuraAutosaveSnapshots, STATGROUP_Aura);
+
+namespace AuraAutosave
+{
+   /** The attributes players change themselves (the secondary ones are derived from them by effects) */
+   static const EAuraAttribute PersistentAttributes[] =
+   {
+      EAuraAttribute::Strength,
+      EAuraAttribute::Intelligence,
+      EAuraAttribute::Resilience,
+      EAuraAttribute::Vigor,
+      EAuraAttribute::Health,
+      EAuraAttribute::Mana
+   };
+}
+
+void UAuraAutosaveSubsystem::RegisterPlayer(AAuraPlayerState* PlayerState, const FString& SlotName, bool bHasSnapshot)
+{
+   UAbilitySystemComponent* ASC = PlayerState ? PlayerState->GetAbilitySystemComponent() : nullptr;
+   if (ASC == nullptr || SlotName.IsEmpty()) return;
+
+   const TObjectKey<AAuraPlayerState> Key(PlayerState);
+   if (FAutosaveEntry* OldEntry = Entries.Find(Key))
+   {
+      UnbindEntry(*OldEntry);
+   }
+
+   FAutosaveEntry& Entry = Entries.Add(Key);
+   Entry.PlayerState = PlayerState;
+   Entry.SlotName = SlotName;
+   Entry.bHasSnapshot = bHasSnapshot;
+   // Nothing saved from this session yet: the first checkpoint writes whatever differs from zero, or the whole snapshot if there's none
+   Entry.bDirty = true;
+   Entry.bEffectsDirty = !bHasSnapshot;
+
+   for (const EAuraAttribute Attribute : AuraAutosave::PersistentAttributes)
+   {
+      const FGameplayAttribute GameplayAttribute = UAuraAttributeSet::GetAttribute(Attribute);
+      const FDelegateHandle Handle = ASC->GetGameplayAttributeValueChangeDelegate(GameplayAttribute).AddWeakLambda(this, [this, Key](const FOnAttributeChangeData&)
+      {
+         MarkDirty(Key, false);
+      });
+      Entry.AttributeHandles.Add({ GameplayAttribute, Handle });
+   }
+   Entry.LevelChangedHandle = PlayerState->OnLevelChangedDelegate.AddWeakLambda(this, [this, Key](int32)
+   {
+      MarkDirty(Key, false);
+   });
+   Entry.EffectAddedHandle = ASC->OnActiveGameplayEffectAddedDelegateToSelf.AddWeakLambda(this, [this, Key](UAbilitySystemComponent*, const FGameplayEffectSpec&, FActiveGameplayEffectHandle)
+   {
+      MarkDirty(Key, true);
+   });
+   Entry.EffectRemovedHandle = ASC->OnAnyGameplayEffectRemovedDelegate().AddWeakLambda(this, [this, Key](const FActiveGameplayEffect&)
+   {
+      MarkDirty(Key, true);
+   });
+}
+
+void UAuraAutosaveSubsystem::UnregisterPlayer(AAuraPlayerState* PlayerState)
+{
+   FAutosaveEntry Entry;
+   if (Entries.RemoveAndCopyValue(TObjectKey<AAuraPlayerState>(PlayerState), Entry))
+   {
+      UnbindEntry(Entry);
+   }
+}
+
+void UAuraAutosaveSubsystem::UnbindEntry(FAutosaveEntry& Entry)
+{
+   AAuraPlayerState* PlayerState = Entry.PlayerState.Get();
+   UAbilitySystemComponent* ASC = PlayerState ? PlayerState->GetAbilitySystemComponent() : nullptr;
+   if (ASC)
+   {
+      for (const TPair<FGameplayAttribute, FDelegateHandle>& AttributeHandle : Entry.AttributeHandles)
+      {
+         ASC->GetGameplayAttributeValueChangeDelegate(AttributeHandle.Key).Remove(AttributeHandle.Value);
+      }
+      ASC->OnActiveGameplayEffectAddedDelegateToSelf.Remove(Entry.EffectAddedHandle);
+      ASC->OnAnyGameplayEffectRemovedDelegate().Remove(Entry.EffectRemovedHandle);
+   }
+   if (PlayerState)
+   {
+      PlayerState->OnLevelChangedDelegate.Remove(Entry.LevelChangedHandle);
+   }
+   Entry.AttributeHandles.Reset();
+}
+
+void UAuraAutosaveSubsystem::MarkDirty(TObjectKey<AAuraPlayerState> Key, bool bEffectsChanged)
+{
+   if (FAutosaveEntry* Entry = Entries.Find(Key))
+   {
+      Entry->bDirty = true;
+      Entry->bEffectsDirty |= bEffectsChanged;
+   }
+}
+
+void UAuraAutosaveSubsystem::Tick(float DeltaTime)
+{
+   if (Entries.IsEmpty()) return;
+
+   TimeSinceCheckpoint += DeltaTime;
+   TimeSinceCompaction += DeltaTime;
+
+   if (TimeSinceCheckpoint >= CheckpointInterval)
+   {
+      TimeSinceCheckpoint = 0.f;
+      Checkpoint();
+   }
+
+   if (TimeSinceCompaction >= CompactionInterval)
+   {
+      TimeSinceCompaction = 0.f;
+      for (TPair<TObjectKey<AAuraPlayerState>, FAutosaveEntry>& Pair : Entries)
+      {
+         if (Pair.Value.JournalRecords > 0 && !Pair.Value.bCompactionQueued)
+         {
+            Pair.Value.bCompactionQueued = true;
+            CompactionQueue.Add(Pair.Key);
+         }
+      }
+   }
+
+   ProcessCompactionQueue();
+}
+
+void UAuraAutosaveSubsystem::Checkpoint()
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(UAuraAutosaveSubsystem::Checkpoint);
+   SCOPE_CYCLE_COUNTER(STAT_AuraAutosaveCheckpoint);
+
+   for (auto It = Entries.CreateIterator(); It; ++It)
+   {
+      FAutosaveEntry& Entry = It.Value();
+      if (!Entry.PlayerState.IsValid())
+      {
+         // Gone without a logout (travel, crash of the connection): the game mode had nothing to save it with
+         It.RemoveCurrent();
+         continue;
+      }
+      if (!Entry.bDirty || Entry.bCompactionQueued) continue;
+
+      // Effects can't be journaled, and long journals make loading slower: those get a full snapshot, spread over the next frames
+      if (Entry.bEffectsDirty || Entry.JournalRecords >= MaxJournalRecords)
+      {
+         Entry.bCompactionQueued = true;
+         CompactionQueue.Add(It.Key());
+         continue;
+      }
+
+      WriteJournalRecord(Entry);
+   }
+}
+
+void UAuraAutosaveSubsystem::WriteJournalRecord(FAutosaveEntry& Entry)
+{
+   const AAuraPlayerState* PlayerState = Entry.PlayerState.Get();
+   const UAbilitySystemComponent* ASC = PlayerState->GetAbilitySystemComponent();
+   const UAuraAttributeSet* AttributeSet = ASC ? ASC->GetSet<UAuraAttributeSet>() : nullptr;
+   if (AttributeSet == nullptr) return;
+
+   FAuraAttributeSnapshot AttributeSnapshot;
+   AttributeSet->GetSnapshot(AttributeSnapshot, true);
+
+   TArray<FAuraJournalAttribute, TInlineAllocator<FAuraAttributeSnapshot::NumAttributes>> ChangedAttributes;
+   for (int32 Index = 0; Index < FAuraAttributeSnapshot::NumAttributes; ++Index)
+   {
+      if (AttributeSnapshot.Base[Index] != Entry.SavedBaseValues[Index])
+      {
+         ChangedAttributes.Add({ static_cast<uint32>(Index), AttributeSnapshot.Base[Index] });
+         Entry.SavedBaseValues[Index] = AttributeSnapshot.Base[Index];
+      }
+   }
+   Entry.bDirty = false;
+
+   // A change that went back to the saved value before the checkpoint: nothing to write
+   if (ChangedAttributes.IsEmpty() && PlayerState->GetPlayerLevel() == Entry.SavedLevel) return;
+   Entry.SavedLevel = PlayerState->GetPlayerLevel();
+
+   TArray<uint8> Bytes;
+   AuraSnapshot::WriteJournalRecord(Entry.SavedLevel, ChangedAttributes, Bytes);
+   AuraSnapshot::AppendJournalAsync(MoveTemp(Bytes), Entry.SlotName);
+   ++Entry.JournalRecords;
+   INC_DWORD_STAT(STAT_AuraAutosaveJournalRecords);
+}
+
+void UAuraAutosaveSubsystem::WriteSnapshot(FAutosaveEntry& Entry)
+{
+   const AAuraPlayerState* PlayerState = Entry.PlayerState.Get();
+   const UAbilitySystemComponent* ASC = PlayerState->GetAbilitySystemComponent();
+   const UAuraAttributeSet* AttributeSet = ASC ? ASC->GetSet<UAuraAttributeSet>() : nullptr;
+   if (AttributeSet == nullptr) return;
+
+   TArray<uint8> Bytes;
+   AuraSnapshot::Capture(*ASC, PlayerState->GetPlayerLevel(), Bytes);
+   AuraSnapshot::WriteSnapshotAsync(MoveTemp(Bytes), Entry.SlotName);
+
+   FAuraAttributeSnapshot AttributeSnapshot;
+   AttributeSet->GetSnapshot(AttributeSnapshot, true);
+   FMemory::Memcpy(Entry.SavedBaseValues, AttributeSnapshot.Base, sizeof(Entry.SavedBaseValues));
+   Entry.SavedLevel = PlayerState->GetPlayerLevel();
+   Entry.JournalRecords = 0;
+   Entry.bHasSnapshot = true;
+   Entry.bDirty = false;
+   Entry.bEffectsDirty = false;
+   INC_DWORD_STAT(STAT_AuraAutosaveSnapshots);
+}
+
+void UAuraAutosaveSubsystem::ProcessCompactionQueue()
+{
+   int32 Budget = FMath::Max(MaxCompactionsPerTick, 1);
+   while (Budget > 0 && !CompactionQueue.IsEmpty())
+   {
+      const TObjectKey<AAuraPlayerState> Key = CompactionQueue[0];
+      CompactionQueue.RemoveAt(0, 1, false);
+
+      FAutosaveEntry* Entry = Entries.Find(Key);
+      if (Entry == nullptr || !Entry->PlayerState.IsValid()) continue;
+
+      Entry->bCompactionQueued = false;
+      WriteSnapshot(*Entry);
+      --Budget;
+   }
+}
+
+void UAuraAutosaveSubsystem::Deinitialize()
+{
+   for (TPair<TObjectKey<AAuraPlayerState>, FAutosaveEntry>& Pair : Entries)
+   {
+      UnbindEntry(Pair.Value);
+   }
+   Entries.Reset();
+   CompactionQueue.Reset();
+
+   Super::Deinitialize();
+}
+
+TStatId UAuraAutosaveSubsystem::GetStatId() const
+{
+   RETURN_QUICK_DECLARE_CYCLE_STAT(UAuraAutosaveSubsystem, STATGROUP_Tickables);
+}
+
+bool UAuraAutosaveSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+   // Gameplay worlds only, no editor preview worlds
+   return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,56 @@
+// Copyright Eveline Gomes.
+
+
+#include "Save/AuraEnemyHibernationSubsystem.h"
+
+#include "Character/AuraEnemy.h"
+#include "Save/AuraAbilitySystemSnapshot.h"
+
+#include "AuraStats.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hibernated Enemies"), STAT_AuraHibernatedEnemies, STATGROUP_Aura);
+
+void UAuraEnemyHibernationSubsystem::Hibernate(const AAuraEnemy* Enemy, const UAbilitySystemComponent& AbilitySystemComponent, int32 Level)
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(UAuraEnemyHibernationSubsystem::Hibernate);
+
+   const FSoftObjectPath Key = GetHibernationKey(Enemy);
+   if (Key.IsNull()) return;
+
+   TArray<uint8>& Blob = Blobs.FindOrAdd(Key);
+   AuraSnapshot::Capture(AbilitySystemComponent, Level, Blob);
+   Blob.Shrink();
+
+   SET_DWORD_STAT(STAT_AuraHibernatedEnemies, Blobs.Num());
+}
+
+bool UAuraEnemyHibernationSubsystem::Rehydrate(const AAuraEnemy* Enemy, UAbilitySystemComponent& AbilitySystemComponent, TFunctionRef<void(int32)> SetLevel)
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(UAuraEnemyHibernationSubsystem::Rehydrate);
+
+   if (Blobs.IsEmpty()) return false;
+
+   TArray<uint8> Blob;
+   if (!Blobs.RemoveAndCopyValue(GetHibernationKey(Enemy), Blob)) return false;
+   SET_DWORD_STAT(STAT_AuraHibernatedEnemies, Blobs.Num());
+
+   FAuraSnapshotView View;
+   if (!AuraSnapshot::Parse(Blob, View)) return false;
+
+   // Level first: the restored effects cache it in their context when they're made
+   SetLevel(View.Header->Level);
+   return AuraSnapshot::Restore(AbilitySystemComponent, View);
+}
+
+FSoftObjectPath UAuraEnemyHibernationSubsystem::GetHibernationKey(const AAuraEnemy* Enemy)
+{
+   // Placed in a level (loaded with it) rather than spawned: its name in the level is stable
+   if (Enemy == nullptr || !Enemy->IsNetStartupActor()) return FSoftObjectPath();
+   return FSoftObjectPath(Enemy);
+}
+
+bool UAuraEnemyHibernationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+   // Gameplay worlds only, no editor preview worlds
+   return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -6,19 +6,66 @@
 /** Create a widget */
 #include "UI/Widget/AuraUserWidget.h"
 
-/** Create an overlay widget controller */
+/** Create the widget controllers */
 #include "UI/WidgetController/OverlayWidgetController.h"
+#include "UI/WidgetController/AttributeMenuWidgetController.h"
 
 /** For initialize the widget and widget controller */
 #include "AbilitySystemComponent.h"
 
+/** Message widgets expiry and deferred overlay creation */
+#include "TimerManager.h"
+
+/** Overlay classes streaming */
+#include "Engine/AssetManager.h"
+
+/** Memory tracking */
+#include "AuraMemoryTracking.h"
+
+#include "AuraLogChannels.h"
+
+void AAuraHUD::BeginPlay()
+{
+   Super::BeginPlay();
+
+   // The pool creates its widgets for our world and owning player, like CreateWidget(GetWorld(), ...) would
+   MessageWidgetPool.SetWorld(GetWorld());
+   MessageWidgetPool.SetDefaultPlayerController(GetOwningPlayerController());
+}
+
+void AAuraHUD::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+   if (OverlayLoadHandle.IsValid())
+   {
+      OverlayLoadHandle->CancelHandle();
+      OverlayLoadHandle.Reset();
+   }
+   GetWorldTimerManager().ClearTimer(OverlayBuildTimerHandle);
+   GetWorldTimerManager().ClearTimer(MessageExpireTimerHandle);
+   LiveMessages.Reset();
+   MessageWidgetPool.ResetPool();
+
+   Super::EndPlay(EndPlayReason);
+}
 
 UOverlayWidgetController* AAuraHUD::GetOverlayWidgetController(const FWidgetControllerParams& WCParams)
 {
+#if UE_SERVER
+   // The server target has no UI, so there's never a widget controller to give out
+   return nullptr;
+#else
    if (OverlayWidgetController == nullptr)
    {
+      // InitOverlay() streams the class in; anyone asking for the controller before that is done pays for a blocking load
+      UClass* ControllerClass = OverlayWidgetControllerClass.Get();
+      if (ControllerClass == nullptr)
+      {
+         ControllerClass = OverlayWidgetControllerClass.LoadSynchronous();
+      }
+
       // Create an overlay widget controller
-      OverlayWidgetController = NewObject<UOverlayWidgetController>(this, OverlayWidgetControllerClass);
+      LLM_SCOPE_BYTAG(Aura_WidgetControllers);
+      OverlayWidgetController = NewObject<UOverlayWidgetController>(this, ControllerClass);
       // Set the widget controller params
       OverlayWidgetController->SetWidgetControllerParams(WCParams);
       // Bind dependencies here, as all 4 key variables has already been set
@@ -26,29 +73,223 @@ UOverlayWidgetController* AAuraHUD::GetOverlayWidgetController(const FWidgetCont
    }
 
    return OverlayWidgetController;
+#endif
+}
+
+UAttributeMenuWidgetController* AAuraHUD::GetAttributeMenuWidgetController()
+{
+#if UE_SERVER
+   return nullptr;
+#else
+   if (AttributeMenuWidgetController == nullptr)
+   {
+      checkf(AttributeMenuWidgetControllerClass, TEXT("Attribute Menu Widget Controller Class uninitialized, please fill out BP_AuraHUD"));
+      checkf(WidgetControllerParams.fAbilitySystemComponent, TEXT("GetAttributeMenuWidgetController() called before InitOverlay()"));
+
+      LLM_SCOPE_BYTAG(Aura_WidgetControllers);
+      AttributeMenuWidgetController = NewObject<UAttributeMenuWidgetController>(this, AttributeMenuWidgetControllerClass);
+      AttributeMenuWidgetController->SetWidgetControllerParams(WidgetControllerParams);
+      // Nothing is requested yet, so this doesn't bind anything until the menu's widgets ask for their attributes
+      AttributeMenuWidgetController->BindCallbacksToDependencies();
+   }
+
+   return AttributeMenuWidgetController;
+#endif
 }
 
 void AAuraHUD::InitOverlay(APlayerController* PC, APlayerState* PS, UAbilitySystemComponent* ASC, UAttributeSet* AS)
 {
+#if !UE_SERVER
    // Perform a check that will also print a formatted string to the crash log if the condition fails and a crash happens
-   checkf(OverlayWidgetClass, TEXT("Overlay Widget Class uninitialized, please fill out BP_AuraHUD"));
-   checkf(OverlayWidgetControllerClass, TEXT("OVerlay Widget Controller Class uninitialize, please fill out BP_AuraHUD"));
-
-   // Create the widget
-   UUserWidget* Widget = CreateWidget<UUserWidget>(GetWorld(), OverlayWidgetClass);
-   // Cast Widget to AuraUserWidget so we can set its widget controller
-   OverlayWidget = Cast<UAuraUserWidget>(Widget);
-   // Before using the OverlayWidget set functions, we need to create the widget controller first.
-   // Create the params struct and pass the parameters received by this function
-   const FWidgetControllerParams WidgetControllerParams{ PC, PS, ASC, AS };
-   // Construct using the AuraHUD GetOverlayWidgetController() and store the return value into a pointer of type UOverlayWidgetController
+   checkf(!OverlayWidgetClass.IsNull(), TEXT("Overlay Widget Class uninitialized, please fill out BP_AuraHUD"));
+   checkf(!OverlayWidgetControllerClass.IsNull(), TEXT("OVerlay Widget Controller Class uninitialize, please fill out BP_AuraHUD"));
+
+   // Create the params struct and pass the parameters received by this function. If a build is already on its way, it'll use these ones.
+   WidgetControllerParams = FWidgetControllerParams(PC, PS, ASC, AS);
+   if (OverlayLoadHandle.IsValid() && OverlayLoadHandle->IsLoadingInProgress()) return;
+
+   // A build that's past the loading step starts over with the new params
+   if (OverlayLoadHandle.IsValid())
+   {
+      OverlayLoadHandle->CancelHandle();
+   }
+   GetWorldTimerManager().ClearTimer(OverlayBuildTimerHandle);
+
+   /**
+   * Stream the widget and controller classes in instead of loading them (and the textures, materials and message widgets they reference) on the
+   *  frame the pawn is possessed. Once they're in memory, later calls (eg on respawn) get the callback without waiting for any IO.
+   */
+   OverlayLoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+      { OverlayWidgetClass.ToSoftObjectPath(), OverlayWidgetControllerClass.ToSoftObjectPath() },
+      FStreamableDelegate::CreateUObject(this, &AAuraHUD::OnOverlayClassesLoaded));
+#endif
+}
+
+void AAuraHUD::OnOverlayClassesLoaded()
+{
+#if !UE_SERVER
+   /**
+   * Frame 1: the widget controller. It binds to the ASC straight away but holds its broadcasts, so the attribute values and messages received
+   *  while the widget doesn't exist yet are kept for it.
+   */
    UOverlayWidgetController* WidgetController = GetOverlayWidgetController(WidgetControllerParams);
+   WidgetController->HoldBroadcasts();
+
+   OverlayBuildTimerHandle = GetWorldTimerManager().SetTimerForNextTick(this, &AAuraHUD::CreateOverlayWidget);
+#endif
+}
+
+void AAuraHUD::CreateOverlayWidget()
+{
+#if !UE_SERVER
+   // Frame 2: create the widget (its Construct only runs when it's added to the viewport, next frame)
+   if (OverlayWidget)
+   {
+      OverlayWidget->RemoveFromParent();
+   }
+   OverlayWidget = CreateWidget<UAuraUserWidget>(GetWorld(), OverlayWidgetClass.Get());
+
+   OverlayBuildTimerHandle = GetWorldTimerManager().SetTimerForNextTick(this, &AAuraHUD::ShowOverlayWidget);
+#endif
+}
+
+void AAuraHUD::ShowOverlayWidget()
+{
+#if !UE_SERVER
+   /**
+   * Frame 3: tie the Overlay widget and overlay widget controller together. The overlay is the one widget that gets collapsed as a whole (menus,
+   *  cinematics, loading), so its visibility decides whether the controller keeps listening to the ASC.
+   */
+   if (OverlayWidget == nullptr || OverlayWidgetController == nullptr) return;
 
-   // Tie the Overlay widget and overlay widget controller together
-   OverlayWidget->SetWidgetController(WidgetController);
-   // Broadcast initial values
-   WidgetController->BroadcastInitialValues();
+   OverlayWidget->bDrivesWidgetControllerSubscriptions = true;
+   OverlayWidget->SetWidgetController(OverlayWidgetController);
+
+   /**
+   * Message widgets are shown by the HUD, from its pool. An overlay BP that still binds MessageWidgetRowDelegate in WidgetControllerSet creates
+   *  its own widgets, so the HUD stays out of it, otherwise every message would show up twice.
+   */
+   FMessageWidgetRowSignature& MessageDelegate = OverlayWidgetController->MessageWidgetRowDelegate;
+   if (MessageDelegate.GetAllObjects().Contains(OverlayWidget.Get()))
+   {
+      MessageDelegate.RemoveDynamic(this, &AAuraHUD::HandleMessageWidgetRow);
+      UE_LOG(LogAura, Warning, TEXT("%s binds MessageWidgetRowDelegate itself: its message widgets aren't pooled"), *GetNameSafe(OverlayWidget->GetClass()));
+   }
+   else
+   {
+      MessageDelegate.AddUniqueDynamic(this, &AAuraHUD::HandleMessageWidgetRow);
+   }
 
    // Finally, add the widget to the viewport.
-   Widget->AddToViewport();
-}
\ No newline at end of file
+   OverlayWidget->AddToViewport();
+
+   // The widget BP is bound to the delegates now: broadcast initial values, then whatever was held while it was being built
+   OverlayWidgetController->ReleaseBroadcasts();
+#endif
+}
+
+void AAuraHUD::HandleMessageWidgetRow(FUIWidgetRow Row)
+{
+   ShowMessageWidget(Row);
+}
+
+UAuraUserWidget* AAuraHUD::ShowMessageWidget(const FUIWidgetRow& Row)
+{
+#if UE_SERVER
+   return nullptr;
+#else
+   if (Row.MessageWidget == nullptr) return nullptr;
+
+   // Game time, like the expiry timer
+   const double Now = GetWorld()->GetTimeSeconds();
+
+   // Same message still on screen and shown recently: merge into it instead of showing another widget
+   for (FLiveMessage& LiveMessage : LiveMessages)
+   {
+      if (LiveMessage.MessageTag == Row.MessageTag && LiveMessage.Widget.IsValid() && Now - LiveMessage.LastShownTime <= MessageCoalesceWindow)
+      {
+         ++LiveMessage.Count;
+         LiveMessage.LastShownTime = Now;
+         LiveMessage.ExpireTime = Now + MessageWidgetLifetime;
+         LiveMessage.Widget->ShowMessage(Row.Message, Row.Image, LiveMessage.Count);
+         ScheduleMessageExpiry();
+         return LiveMessage.Widget.Get();
+      }
+   }
+
+   // Too many on screen: recycle the oldest one
+   while (LiveMessages.Num() >= MaxLiveMessageWidgets)
+   {
+      RemoveLiveMessage(0);
+   }
+
+   UAuraUserWidget* MessageWidget = MessageWidgetPool.GetOrCreateInstance<UAuraUserWidget>(Row.MessageWidget);
+   if (MessageWidget == nullptr) return nullptr;
+
+   FLiveMessage& LiveMessage = LiveMessages.AddDefaulted_GetRef();
+   LiveMessage.Widget = MessageWidget;
+   LiveMessage.MessageTag = Row.MessageTag;
+   LiveMessage.LastShownTime = Now;
+   LiveMessage.ExpireTime = Now + MessageWidgetLifetime;
+
+   MessageWidget->OnMessageFinished.BindUObject(this, &AAuraHUD::ReleaseMessageWidget);
+   MessageWidget->AddToViewport();
+   MessageWidget->ShowMessage(Row.Message, Row.Image, LiveMessage.Count);
+   ScheduleMessageExpiry();
+
+   return MessageWidget;
+#endif
+}
+
+void AAuraHUD::ReleaseMessageWidget(UAuraUserWidget* MessageWidget)
+{
+   const int32 Index = LiveMessages.IndexOfByPredicate([MessageWidget](const FLiveMessage& LiveMessage) { return LiveMessage.Widget.Get() == MessageWidget; });
+   if (Index != INDEX_NONE)
+   {
+      RemoveLiveMessage(Index);
+      ScheduleMessageExpiry();
+   }
+}
+
+void AAuraHUD::RemoveLiveMessage(int32 Index)
+{
+   if (UAuraUserWidget* MessageWidget = LiveMessages[Index].Widget.Get())
+   {
+      MessageWidget->OnMessageFinished.Unbind();
+      MessageWidget->RemoveFromParent();
+      MessageWidgetPool.Release(MessageWidget);
+   }
+   LiveMessages.RemoveAt(Index);
+}
+
+void AAuraHUD::ExpireMessageWidgets()
+{
+   const double Now = GetWorld()->GetTimeSeconds();
+   for (int32 Index = LiveMessages.Num() - 1; Index >= 0; --Index)
+   {
+      if (LiveMessages[Index].ExpireTime <= Now || !LiveMessages[Index].Widget.IsValid())
+      {
+         RemoveLiveMessage(Index);
+      }
+   }
+   ScheduleMessageExpiry();
+}
+
+void AAuraHUD::ScheduleMessageExpiry()
+{
+   // One timer for the message that expires first, instead of one timer per widget
+   if (LiveMessages.IsEmpty())
+   {
+      GetWorldTimerManager().ClearTimer(MessageExpireTimerHandle);
+      return;
+   }
+
+   double NextExpireTime = LiveMessages[0].ExpireTime;
+   for (const FLiveMessage& LiveMessage : LiveMessages)
+   {
+      NextExpireTime = FMath::Min(NextExpireTime, LiveMessage.ExpireTime);
+   }
+
+   const float Delay = FMath::Max(static_cast<float>(NextExpireTime - GetWorld()->GetTimeSeconds()), KINDA_SMALL_NUMBER);
+   GetWorldTimerManager().SetTimer(MessageExpireTimerHandle, this, &AAuraHUD::ExpireMessageWidgets, Delay, false);
+}
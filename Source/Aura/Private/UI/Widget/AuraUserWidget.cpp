@@ -3,8 +3,69 @@
 
 #include "UI/Widget/AuraUserWidget.h"
 
+#include "UI/WidgetController/AuraWidgetController.h"
+
 void UAuraUserWidget::SetWidgetController(UObject* InWidgetController)
 {
+#if !UE_SERVER
+   // The previous controller shouldn't wait for this widget anymore, and the new one only hears about it if it's already on screen (otherwise
+   //  NativeConstruct reports it)
+   ReportVisibilityToWidgetController(false);
+
    WidgetController = InWidgetController;
    WidgetControllerSet();
+
+   if (GetCachedWidget().IsValid())
+   {
+      ReportVisibilityToWidgetController(IsVisible());
+   }
+#endif
+}
+
+void UAuraUserWidget::NativeConstruct()
+{
+   Super::NativeConstruct();
+
+   OnVisibilityChanged.AddUniqueDynamic(this, &UAuraUserWidget::HandleVisibilityChanged);
+   ReportVisibilityToWidgetController(IsVisible());
+}
+
+void UAuraUserWidget::NativeDestruct()
+{
+   OnVisibilityChanged.RemoveDynamic(this, &UAuraUserWidget::HandleVisibilityChanged);
+   ReportVisibilityToWidgetController(false);
+
+   Super::NativeDestruct();
+}
+
+void UAuraUserWidget::HandleVisibilityChanged(ESlateVisibility InVisibility)
+{
+   ReportVisibilityToWidgetController(InVisibility != ESlateVisibility::Collapsed && InVisibility != ESlateVisibility::Hidden);
+}
+
+void UAuraUserWidget::ReportVisibilityToWidgetController(bool bVisible) const
+{
+   if (!bDrivesWidgetControllerSubscriptions) return;
+
+   if (UAuraWidgetController* AuraWidgetController = Cast<UAuraWidgetController>(WidgetController))
+   {
+      AuraWidgetController->SetWidgetVisibility(this, bVisible);
+   }
+}
+
+void UAuraUserWidget::ShowMessage(const FText& Message, UTexture2D* Image, int32 Count)
+{
+   TGuardValue<bool> ShowingGuard(bShowingMessage, true);
+   MessageShown(Message, Image, Count);
+}
+
+void UAuraUserWidget::OnAnimationFinished_Implementation(const UWidgetAnimation* Animation)
+{
+   Super::OnAnimationFinished_Implementation(Animation);
+
+   // A message widget with an intro and an outro animation is only done once both have played
+   if (!bShowingMessage && !IsAnyAnimationPlaying())
+   {
+      OnMessageFinished.ExecuteIfBound(this);
+   }
 }
@@ -0,0 +1,91 @@
+// Copyright Eveline Gomes.
+
+
+#include "UI/WidgetController/AttributeMenuWidgetController.h"
+
+/** Tag -> attribute registry */
+#include "AbilitySystem/AuraAttributeSet.h"
+
+#include "AuraLogChannels.h"
+#include "AuraStats.h"
+
+void UAttributeMenuWidgetController::BroadcastInitialValues()
+{
+#if !UE_SERVER
+   const TMap<FGameplayTag, FGameplayAttribute>& TagsToAttributes = UAuraAttributeSet::GetTagsToAttributes();
+   for (const TPair<FGameplayTag, int32>& Request : AttributeRequests)
+   {
+      BroadcastAttribute(Request.Key, TagsToAttributes.FindChecked(Request.Key));
+   }
+#endif
+}
+
+void UAttributeMenuWidgetController::BindCallbacksToDependencies()
+{
+#if !UE_SERVER
+   const TMap<FGameplayTag, FGameplayAttribute>& TagsToAttributes = UAuraAttributeSet::GetTagsToAttributes();
+   for (const TPair<FGameplayTag, int32>& Request : AttributeRequests)
+   {
+      BindAttribute(Request.Key, TagsToAttributes.FindChecked(Request.Key));
+   }
+#endif
+}
+
+void UAttributeMenuWidgetController::RequestAttribute(FGameplayTag AttributeTag)
+{
+#if !UE_SERVER
+   const FGameplayAttribute* Attribute = UAuraAttributeSet::GetTagsToAttributes().Find(AttributeTag);
+   if (Attribute == nullptr)
+   {
+      UE_LOG(LogAura, Warning, TEXT("%s requested %s, which isn't a registered attribute tag"), *GetName(), *AttributeTag.ToString());
+      return;
+   }
+
+   int32& RequestCount = AttributeRequests.FindOrAdd(AttributeTag);
+   ++RequestCount;
+
+   // Without the controller params there's nothing to bind to yet; BindCallbacksToDependencies() binds every requested attribute later
+   if (AbilitySystemComponent == nullptr) return;
+
+   // First request: bind to it now, unless the subscriptions are suspended (resuming binds every requested attribute)
+   if (RequestCount == 1 && !AreSubscriptionsSuspended())
+   {
+      BindAttribute(AttributeTag, *Attribute);
+   }
+
+   // The widget asking for it needs a value to start with, even if other widgets already had one
+   BroadcastAttribute(AttributeTag, *Attribute);
+#endif
+}
+
+void UAttributeMenuWidgetController::ReleaseAttribute(FGameplayTag AttributeTag)
+{
+#if !UE_SERVER
+   int32* RequestCount = AttributeRequests.Find(AttributeTag);
+   if (RequestCount == nullptr) return;
+
+   if (--(*RequestCount) <= 0)
+   {
+      AttributeRequests.Remove(AttributeTag);
+      UnbindAttributeChange(UAuraAttributeSet::GetTagsToAttributes().FindChecked(AttributeTag));
+   }
+#endif
+}
+
+void UAttributeMenuWidgetController::BindAttribute(const FGameplayTag& AttributeTag, const FGameplayAttribute& Attribute)
+{
+   BindAttributeChange(Attribute,
+      [this, AttributeTag](const FOnAttributeChangeData& Data)
+      {
+         OnAttributeValueChanged.Broadcast(AttributeTag, Data.NewValue);
+         AURA_COUNT_WIDGET_BROADCASTS(1);
+      }
+   );
+}
+
+void UAttributeMenuWidgetController::BroadcastAttribute(const FGameplayTag& AttributeTag, const FGameplayAttribute& Attribute)
+{
+   // The value from the ASC works for any attribute set holding this attribute, without having to cast AttributeSet
+   OnAttributeValueChanged.Broadcast(AttributeTag, AbilitySystemComponent->GetNumericAttribute(Attribute));
+   AURA_COUNT_WIDGET_BROADCASTS(1);
+}
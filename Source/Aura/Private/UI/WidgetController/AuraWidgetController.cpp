@@ -5,10 +5,12 @@
 
 void UAuraWidgetController::SetWidgetControllerParams(const FWidgetControllerParams& WCParams)
 {
+#if !UE_SERVER
    PlayerController = WCParams.fPlayerController;
    PlayerState = WCParams.fPlayerState;
    AbilitySystemComponent = WCParams.fAbilitySystemComponent;
    AttributeSet = WCParams.fAttributeSet;
+#endif
 }
 
 void UAuraWidgetController::BroadcastInitialValues()
@@ -20,3 +22,64 @@ void UAuraWidgetController::BindCallbacksToDependencies()
 {
 
 }
+
+void UAuraWidgetController::UnbindCallbacksFromDependencies()
+{
+   if (AbilitySystemComponent)
+   {
+      for (const TPair<FGameplayAttribute, FDelegateHandle>& AttributeHandle : AttributeChangeHandles)
+      {
+         AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(AttributeHandle.Key).Remove(AttributeHandle.Value);
+      }
+   }
+   AttributeChangeHandles.Reset();
+}
+
+void UAuraWidgetController::UnbindAttributeChange(const FGameplayAttribute& Attribute)
+{
+   for (int32 Index = AttributeChangeHandles.Num() - 1; Index >= 0; --Index)
+   {
+      if (AttributeChangeHandles[Index].Key != Attribute) continue;
+
+      if (AbilitySystemComponent)
+      {
+         AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(Attribute).Remove(AttributeChangeHandles[Index].Value);
+      }
+      AttributeChangeHandles.RemoveAtSwap(Index);
+   }
+}
+
+void UAuraWidgetController::SetWidgetVisibility(const UObject* Widget, bool bVisible)
+{
+   if (bVisible)
+   {
+      VisibleWidgets.Add(FObjectKey(Widget));
+      ResumeSubscriptions();
+   }
+   else
+   {
+      VisibleWidgets.Remove(FObjectKey(Widget));
+      if (VisibleWidgets.IsEmpty())
+      {
+         SuspendSubscriptions();
+      }
+   }
+}
+
+void UAuraWidgetController::SuspendSubscriptions()
+{
+   if (bSubscriptionsSuspended) return;
+
+   bSubscriptionsSuspended = true;
+   UnbindCallbacksFromDependencies();
+}
+
+void UAuraWidgetController::ResumeSubscriptions()
+{
+   if (!bSubscriptionsSuspended) return;
+
+   bSubscriptionsSuspended = false;
+   BindCallbacksToDependencies();
+   // One snapshot instead of replaying everything that changed while hidden
+   BroadcastInitialValues();
+}
@@ -7,9 +7,22 @@
 #include "AbilitySystem/AuraAttributeSet.h"
 #include "AbilitySystem/AuraAbilitySystemComponent.h"
 
+/** Message rows index */
+#include "AuraGameplayTags.h"
+#include "AuraLogChannels.h"
+
+/** Attribute UI bus flush */
+#include "GameFramework/PlayerController.h"
+#include "TimerManager.h"
+
+#include "AuraStats.h"
+
 void UOverlayWidgetController::BroadcastInitialValues()
 {
+   TRACE_CPUPROFILER_EVENT_SCOPE(UOverlayWidgetController::BroadcastInitialValues);
+
    // No need to call super since it's empty
+#if !UE_SERVER
 
    /** 
    * Take the delegates and broadcast some values.
@@ -29,13 +42,18 @@ void UOverlayWidgetController::BroadcastInitialValues()
    */
    
    const UAuraAttributeSet* AuraAttributeSet = CastChecked<UAuraAttributeSet>(AttributeSet);
+   // All the values in one copy, instead of a getter per attribute
+   FAuraAttributeSnapshot Snapshot;
+   AuraAttributeSet->GetSnapshot(Snapshot);
+
    /** Broadcast initial values */
    // Health
-   OnHealthChanged.Broadcast(AuraAttributeSet->GetHealth());
-   OnMaxHealthChanged.Broadcast(AuraAttributeSet->GetMaxHealth());
+   OnHealthChanged.Broadcast(Snapshot.Get(EAuraAttribute::Health));
+   OnMaxHealthChanged.Broadcast(Snapshot.Get(EAuraAttribute::MaxHealth));
    // Mana
-   OnManaChanged.Broadcast(AuraAttributeSet->GetMana());
-   OnMaxManaChanged.Broadcast(AuraAttributeSet->GetMaxMana());
+   OnManaChanged.Broadcast(Snapshot.Get(EAuraAttribute::Mana));
+   OnMaxManaChanged.Broadcast(Snapshot.Get(EAuraAttribute::MaxMana));
+   AURA_COUNT_WIDGET_BROADCASTS(4);
 
    /** 
    * For us to be able to respond to when those attributes change, we'll use a function from the Ability System Component that requires the
@@ -49,16 +67,25 @@ void UOverlayWidgetController::BroadcastInitialValues()
    * Then, we create (in this class/child class!) the bind functions using the specific signature needed.
    */
    //AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(AuraAttributeSet->GetHealthAttribute()).AddUObject(this, &callback fully qualified);
+#endif
 }
 
 void UOverlayWidgetController::BindCallbacksToDependencies()
 {
    // No need to call Super (it's empty)
+#if !UE_SERVER
 
    /** Bind callback functions/lambads to be called whenever the attribute related to it changes. */
 
    const UAuraAttributeSet* AuraAttributeSet = Cast<UAuraAttributeSet>(AttributeSet);
 
+   // The message lambda below only reads the index, so it has to be ready before anything gets bound (only once, binding again after a
+   //  suspended subscription reuses it)
+   if (!bMessageRowIndexBuilt)
+   {
+      BuildMessageRowIndex();
+   }
+
    /** 
    * Suggestion from a user in L62: using macro to reduce repetitive code (many other suggestions!)
    * https://www.udemy.com/course/unreal-engine-5-gas-top-down-rpg/learn/lecture/39783730#questions/20820728
@@ -76,41 +103,38 @@ void UOverlayWidgetController::BindCallbacksToDependencies()
    #undef BIND_CALLBACKS
    */
 
-   AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(
-      AuraAttributeSet->GetHealthAttribute()).AddLambda(
-         [this](const FOnAttributeChangeData& Data)
-         {
-            /**
-            * All we want to do when the health changes is to broadcast the value through OnHealthChanged delegate, so the widgets can respond to it.
-            * We use Data.NewValue to get the value that has just changed (instead of using AuraAttributeSet->GetHealth()).
-            */
-            OnHealthChanged.Broadcast(Data.NewValue);
-         }
-      );
+   BindAttributeChange(AuraAttributeSet->GetHealthAttribute(),
+      [this](const FOnAttributeChangeData& Data)
+      {
+         /**
+         * All we want to do when the health changes is to broadcast the value through OnHealthChanged delegate, so the widgets can respond to it.
+         * We use Data.NewValue to get the value that has just changed (instead of using AuraAttributeSet->GetHealth()).
+         * The broadcast itself is queued, so several changes in the same frame end up as one broadcast with the latest value.
+         */
+         QueueAttributeBroadcast(EOverlayAttribute::Health, Data.NewValue);
+      }
+   );
 
-   AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(
-      AuraAttributeSet->GetMaxHealthAttribute()).AddLambda(
-         [this](const FOnAttributeChangeData& Data)
-         {
-            OnMaxHealthChanged.Broadcast(Data.NewValue);
-         }
-      );
+   BindAttributeChange(AuraAttributeSet->GetMaxHealthAttribute(),
+      [this](const FOnAttributeChangeData& Data)
+      {
+         QueueAttributeBroadcast(EOverlayAttribute::MaxHealth, Data.NewValue);
+      }
+   );
 
-   AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(
-      AuraAttributeSet->GetManaAttribute()).AddLambda(
-         [this](const FOnAttributeChangeData& Data)
-         {
-            OnManaChanged.Broadcast(Data.NewValue);
-         }
-      );
+   BindAttributeChange(AuraAttributeSet->GetManaAttribute(),
+      [this](const FOnAttributeChangeData& Data)
+      {
+         QueueAttributeBroadcast(EOverlayAttribute::Mana, Data.NewValue);
+      }
+   );
 
-   AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(
-      AuraAttributeSet->GetMaxManaAttribute()).AddLambda(
-         [this](const FOnAttributeChangeData& Data)
-         {
-            OnMaxManaChanged.Broadcast(Data.NewValue);
-         }
-      );
+   BindAttributeChange(AuraAttributeSet->GetMaxManaAttribute(),
+      [this](const FOnAttributeChangeData& Data)
+      {
+         QueueAttributeBroadcast(EOverlayAttribute::MaxMana, Data.NewValue);
+      }
+   );
 
    /** 
    * Get AuraASC to bind to its delegate: EFfectAssetTags.
@@ -126,7 +150,7 @@ void UOverlayWidgetController::BindCallbacksToDependencies()
    * We'll create a data table that has information related to GTs specifically to show messages to the screen. The row structute will be defined 
    *  here in C++ as a struct, in the .h file of this class.
    */
-   Cast<UAuraAbilitySystemComponent>(AbilitySystemComponent)->EffectAssetTags.AddLambda(
+   EffectAssetTagsHandle = Cast<UAuraAbilitySystemComponent>(AbilitySystemComponent)->EffectAssetTags.AddWeakLambda(this,
       [this](const FGameplayTagContainer& AssetTags) 
       {
          /** 
@@ -152,15 +176,168 @@ void UOverlayWidgetController::BindCallbacksToDependencies()
          for (const FGameplayTag& Tag : AssetTags)
          {
             /* Check if the Tag belongs to a Message root GT before looking for the row and broadcasting this row */
-            FGameplayTag MessageTag = FGameplayTag::RequestGameplayTag(FName("Message"));
-            if (Tag.MatchesTag(MessageTag))
+            if (Tag.MatchesTag(FAuraGameplayTags::Message))
             {
-               /* Perform a look up to find the row in the DT that correspond to the tag */
-               const FUIWidgetRow* Row = GetDataTableRowByTag<FUIWidgetRow>(MessageWidgetDataTable, Tag);
-               /* Broadcast the row */
-               MessageWidgetRowDelegate.Broadcast(*Row);
+               /* Look up the row in the index built from the DT (a hash probe on the tag instead of a FindRow by name) */
+               if (const FUIWidgetRow* Row = MessageRowsByTag.Find(Tag))
+               {
+                  /* Broadcast the row (or keep it for when the overlay is ready) */
+                  if (bBroadcastsHeld)
+                  {
+                     HeldMessageRows.Add(*Row);
+                  }
+                  else
+                  {
+                     MessageWidgetRowDelegate.Broadcast(*Row);
+                     AURA_COUNT_WIDGET_BROADCASTS(1);
+                  }
+               }
+               else
+               {
+                  // A Message tag without a row in the DT: count it instead of dereferencing a null row
+                  ++MissingMessageRowCount;
+                  UE_LOG(LogAura, Warning, TEXT("No row for %s in %s (%d missing so far)"), *Tag.ToString(), *GetNameSafe(MessageWidgetDataTable), MissingMessageRowCount);
+               }
             }
          }
       }
    );
+#endif
+}
+
+void UOverlayWidgetController::UnbindCallbacksFromDependencies()
+{
+   Super::UnbindCallbacksFromDependencies();
+
+   if (UAuraAbilitySystemComponent* AuraASC = Cast<UAuraAbilitySystemComponent>(AbilitySystemComponent))
+   {
+      AuraASC->EffectAssetTags.Remove(EffectAssetTagsHandle);
+   }
+   EffectAssetTagsHandle.Reset();
+
+   // Values queued before suspending would be stale by the time we resume, and resuming broadcasts a fresh snapshot anyway
+   DirtyAttributesMask = 0;
+   if (const UWorld* World = PlayerController ? PlayerController->GetWorld() : nullptr)
+   {
+      World->GetTimerManager().ClearTimer(FlushTimerHandle);
+   }
+}
+
+void UOverlayWidgetController::HoldBroadcasts()
+{
+   bBroadcastsHeld = true;
+}
+
+void UOverlayWidgetController::ReleaseBroadcasts()
+{
+   if (!bBroadcastsHeld) return;
+
+   bBroadcastsHeld = false;
+
+   // The held attribute values are all covered by the snapshot, which reads the latest ones from the attribute set
+   DirtyAttributesMask = 0;
+   BroadcastInitialValues();
+
+   TArray<FUIWidgetRow> Rows = MoveTemp(HeldMessageRows);
+   for (const FUIWidgetRow& Row : Rows)
+   {
+      MessageWidgetRowDelegate.Broadcast(Row);
+   }
+   AURA_COUNT_WIDGET_BROADCASTS(Rows.Num());
+}
+
+void UOverlayWidgetController::QueueAttributeBroadcast(EOverlayAttribute Attribute, float NewValue)
+{
+   const uint8 Index = static_cast<uint8>(Attribute);
+   PendingValues[Index] = NewValue;
+   DirtyAttributesMask |= 1 << Index;
+
+   // Kept until ReleaseBroadcasts()
+   if (bBroadcastsHeld) return;
+
+   UWorld* World = PlayerController ? PlayerController->GetWorld() : nullptr;
+   if (World == nullptr)
+   {
+      // No world to schedule a flush in, so there's nothing to coalesce with
+      FlushAttributeBroadcasts();
+      return;
+   }
+
+   // A flush is already scheduled and will pick up this value
+   FTimerManager& TimerManager = World->GetTimerManager();
+   if (TimerManager.TimerExists(FlushTimerHandle)) return;
+
+   const double TimeSinceLastFlush = World->GetRealTimeSeconds() - LastFlushTime;
+   if (MinBroadcastInterval > 0.f && TimeSinceLastFlush < MinBroadcastInterval)
+   {
+      TimerManager.SetTimer(FlushTimerHandle, this, &UOverlayWidgetController::FlushAttributeBroadcasts, MinBroadcastInterval - TimeSinceLastFlush, false);
+   }
+   else
+   {
+      FlushTimerHandle = TimerManager.SetTimerForNextTick(this, &UOverlayWidgetController::FlushAttributeBroadcasts);
+   }
+}
+
+void UOverlayWidgetController::FlushAttributeBroadcasts()
+{
+   TRACE_CPUPROFILER_EVENT_SCOPE(UOverlayWidgetController::FlushAttributeBroadcasts);
+
+   FlushTimerHandle.Invalidate();
+   if (const UWorld* World = PlayerController ? PlayerController->GetWorld() : nullptr)
+   {
+      LastFlushTime = World->GetRealTimeSeconds();
+   }
+
+   // Clear the mask before broadcasting, in case a Blueprint bound to one of the delegates changes an attribute and queues it again
+   const uint8 DirtyMask = DirtyAttributesMask;
+   DirtyAttributesMask = 0;
+
+   for (uint8 Index = 0; Index < static_cast<uint8>(EOverlayAttribute::Num); ++Index)
+   {
+      if (DirtyMask & (1 << Index))
+      {
+         GetAttributeDelegate(static_cast<EOverlayAttribute>(Index)).Broadcast(PendingValues[Index]);
+         AURA_COUNT_WIDGET_BROADCASTS(1);
+      }
+   }
+}
+
+FOnAttributeChangedSignature& UOverlayWidgetController::GetAttributeDelegate(EOverlayAttribute Attribute)
+{
+   switch (Attribute)
+   {
+   case EOverlayAttribute::MaxHealth:
+      return OnMaxHealthChanged;
+   case EOverlayAttribute::Mana:
+      return OnManaChanged;
+   case EOverlayAttribute::MaxMana:
+      return OnMaxManaChanged;
+   case EOverlayAttribute::Health:
+   default:
+      return OnHealthChanged;
+   }
+}
+
+void UOverlayWidgetController::BuildMessageRowIndex()
+{
+   bMessageRowIndexBuilt = true;
+
+   MessageRowsByTag.Reset();
+   MissingMessageRowCount = 0;
+   if (MessageWidgetDataTable == nullptr) return;
+
+   /**
+   * Rows used to be found by name (GetDataTableRowByTag uses the tag name as the row name), so the row name stays the key. The MessageTag inside
+   *  the row is only used as a fallback for rows whose name isn't a valid tag.
+   */
+   MessageWidgetDataTable->ForeachRow<FUIWidgetRow>(TEXT("BuildMessageRowIndex"),
+      [this](const FName& RowName, const FUIWidgetRow& Row)
+      {
+         const FGameplayTag RowTag = FGameplayTag::RequestGameplayTag(RowName, false);
+         const FGameplayTag Key = RowTag.IsValid() ? RowTag : Row.MessageTag;
+         if (Key.IsValid())
+         {
+            MessageRowsByTag.Add(Key, Row);
+         }
+      });
 }
@@ -40,14 +40,63 @@ public:
 	*/
 	void AbilityActorInfoSet();
 
+	/**
+	* The level of this ASC's avatar changed (player level up). Server only.
+	* The default attribute effects (applied by AAuraCharacterBase::ApplyEffectToSelf) with a modifier calculated by a level reading MMC get the
+	*  new level in their effect context, and their magnitudes are recalculated in one batch. Their spec level doesn't change, and no other
+	*  effect is touched (effect actor effects keep the actor level they were made with).
+	*/
+	void SetCombatLevel(int32 NewLevel);
+
+	/** A new number for every area damage hit dealt by this ASC, mixed into the roll seed so casts with the same seed don't roll the same */
+	uint32 NextDamageRollSequence() { return DamageRollSequence++; }
+
 	/* Broadcast asset tags from EffectApplied() */
 	FEffectAssetTags EffectAssetTags;
 
+	/** Begin UAbilitySystemComponent */
+	// Both add a memory tracking scope (Aura/EffectSpecs and Aura/ActiveEffects) around the base implementation.
+	// MakeOutgoingSpec also resolves the source info of the Aura effect context (FAuraGameplayEffectContext::ResolveSourceInfo).
+	// ApplyGameplayEffectSpecToSelf queues instant effects on the server, see FlushApplicationQueue.
+	virtual FGameplayEffectSpecHandle MakeOutgoingSpec(TSubclassOf<UGameplayEffect> GameplayEffectClass, float Level, FGameplayEffectContextHandle Context) const override;
+	virtual FActiveGameplayEffectHandle ApplyGameplayEffectSpecToSelf(const FGameplayEffectSpec& GameplayEffect, FPredictionKey PredictionKey = FPredictionKey()) override;
+	/** End UAbilitySystemComponent */
+
+	/**
+	* Instant effects applied to this ASC on the server from outside an ability (effect actors and other external sources: no prediction key and
+	*  no ability in their context) go into a queue instead of executing right away, and the queue is flushed on the next tick. They execute one
+	*  frame (or more, over budget) after they were applied (ApplyGameplayEffectSpecToSelf still returns a handle that reports them as applied). While queued:
+	*  - identical applications (same effect class, level, instigator, causer, source object, set by caller magnitudes and dynamic tags) are
+	*    merged into one spec with a higher stack count, which executes as one application of the summed magnitudes. Only effects without
+	*    executions whose modifiers are all additive, with a scalable float or set by caller magnitude, are merged: for anything else the stack
+	*    count doesn't give the same result as separate applications;
+	*  - at most Aura.Effects.MaxApplicationsPerFrame (merged) applications are executed per flush, the others wait for the next frame.
+	* The default attribute effects (applied to self, see FAuraGameplayEffectContext::IsAppliedToSelf) and effects from abilities (costs, damage)
+	*  are never queued.
+	* "stat Aura" shows the merged, deferred and executed applications. Aura.Effects.QueueInstantEffects 0 executes them right away again.
+	*/
+	void FlushApplicationQueue();
+
+	/** ApplyGameplayEffectSpecToSelf without the queue, for callers that need the effect executed in this frame (eg the latency probe) */
+	FActiveGameplayEffectHandle ApplyGameplayEffectSpecToSelfUnqueued(const FGameplayEffectSpec& GameplayEffect, FPredictionKey PredictionKey = FPredictionKey());
+
 protected:
 	/** Begin UAbilitySystemComponent */
 	// Callback to bind to the multicast delegate on UASC class of type FOnGameplayEffectAppliedDelegate
 	void EffectApplied(UAbilitySystemComponent* AbilitySystemComponent, const FGameplayEffectSpec& EffectSpec, FActiveGameplayEffectHandle ActiveEffectHandle);
 	/** End UAbilitySystemComponent */
 
+private:
+	bool ShouldQueueApplication(const FGameplayEffectSpec& Spec, const FPredictionKey& PredictionKey) const;
+	void QueueApplication(const FGameplayEffectSpec& Spec);
+
+	/** Instant specs waiting for FlushApplicationQueue, merged ones included (stack count > 1) */
+	TArray<FGameplayEffectSpec> QueuedApplications;
+	FTimerHandle ApplicationQueueTimerHandle;
+	bool bFlushingApplicationQueue = false;
+	bool bBypassingApplicationQueue = false;
+
+	uint32 DamageRollSequence = 0;
+
 
 };
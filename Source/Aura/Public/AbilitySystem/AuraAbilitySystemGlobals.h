@@ -0,0 +1,22 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AbilitySystemGlobals.h"
+#include "AuraAbilitySystemGlobals.generated.h"
+
+/**
+ * Project ability system globals (AbilitySystemGlobalsClassName in DefaultGame.ini).
+ * Its only job for now is to make every effect context an FAuraGameplayEffectContext.
+ */
+UCLASS()
+class AURA_API UAuraAbilitySystemGlobals : public UAbilitySystemGlobals
+{
+	GENERATED_BODY()
+
+public:
+	/** Begin UAbilitySystemGlobals */
+	virtual FGameplayEffectContext* AllocGameplayEffectContext() const override;
+	/** End UAbilitySystemGlobals */
+};
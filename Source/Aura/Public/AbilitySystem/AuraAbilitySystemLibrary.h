@@ -0,0 +1,29 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "AuraAbilitySystemLibrary.generated.h"
+
+/**
+ * Ability system helpers for Blueprints (abilities, effect actors, level scripts)
+ */
+UCLASS()
+class AURA_API UAuraAbilitySystemLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Hit every target with BaseDamage from SourceActor at once (AoE), server only.
+	 * The source's ArmorPenetration, CriticalHitChance and CriticalHitDamage and each target's Armor, BlockChance and CriticalHitResistance
+	 *  are gathered into one FAuraDamageBatch, resolved together, and the new Health of every target is written right after, in one pass.
+	 * Targets without an Aura attribute set, and dead ones, are skipped. Seed drives the block and critical rolls, mixed with a counter of the
+	 *  source ASC, so repeated casts with the same seed don't roll the same crits and blocks.
+	 * Health is written without a GE execution: PostGameplayEffectExecute doesn't run, so anything that reacts to damage there won't see it.
+	 * Returns the number of targets that took damage.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "AuraAbilitySystemLibrary|Damage", meta = (DefaultToSelf = "SourceActor"))
+	static int32 ApplyAreaDamage(AActor* SourceActor, const TArray<AActor*>& TargetActors, float BaseDamage, int32 Seed);
+};
@@ -0,0 +1,72 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayEffectTypes.h"
+#include "AuraAbilityTypes.generated.h"
+
+class ACharacter;
+class AController;
+
+/**
+ * Effect context of every Aura effect (allocated by UAuraAbilitySystemGlobals).
+ * On top of the base context it keeps the source's avatar, controller, character and level. They're resolved once, by ResolveSourceInfo(), when
+ *  UAuraAbilitySystemComponent makes the outgoing spec, so SetEffectProperties and the MMCs read them instead of going through the actor info
+ *  and casting on every modifier evaluation.
+ */
+USTRUCT(BlueprintType)
+struct AURA_API FAuraGameplayEffectContext : public FGameplayEffectContext
+{
+	GENERATED_BODY()
+
+public:
+	/** The Aura context of a handle, or nullptr if the handle is empty or holds a context of another type */
+	static const FAuraGameplayEffectContext* Get(const FGameplayEffectContextHandle& Handle);
+	static FAuraGameplayEffectContext* GetMutable(FGameplayEffectContextHandle& Handle);
+
+	/** Look up the source's avatar, controller, character and level. Called after the instigator and source object are set. */
+	void ResolveSourceInfo();
+
+	bool HasSourceInfo() const { return bSourceInfoResolved; }
+	AActor* GetSourceAvatarActor() const { return SourceAvatarActor.Get(); }
+	AController* GetSourceController() const { return SourceController.Get(); }
+	ACharacter* GetSourceCharacter() const { return SourceCharacter.Get(); }
+	int32 GetSourceLevel() const { return SourceLevel; }
+
+	/** Level changes of the source after the spec was made are pushed here, see UAuraAbilitySystemComponent::SetCombatLevel */
+	void SetSourceLevel(int32 InSourceLevel) { SourceLevel = InSourceLevel; }
+
+	/**
+	* Set by AAuraCharacterBase::ApplyEffectToSelf (the default attributes) and by snapshot restores, server side. These are the effects that
+	*  follow the character's level, are saved with its progression and are never queued. Effects the ASC is both source and target of for other
+	*  reasons (effect actors make their context from the target's ASC) don't have it.
+	*/
+	void SetAppliedToSelf(bool bInAppliedToSelf) { bAppliedToSelf = bInAppliedToSelf; }
+	bool IsAppliedToSelf() const { return bAppliedToSelf; }
+
+	/** Begin FGameplayEffectContext */
+	virtual UScriptStruct* GetScriptStruct() const override { return StaticStruct(); }
+	virtual FAuraGameplayEffectContext* Duplicate() const override;
+	virtual bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) override;
+	/** End FGameplayEffectContext */
+
+protected:
+	TWeakObjectPtr<AActor> SourceAvatarActor;
+	TWeakObjectPtr<AController> SourceController;
+	TWeakObjectPtr<ACharacter> SourceCharacter;
+	int32 SourceLevel = 0;
+	bool bSourceInfoResolved = false;
+	// Server only, not replicated
+	bool bAppliedToSelf = false;
+};
+
+template<>
+struct TStructOpsTypeTraits<FAuraGameplayEffectContext> : public TStructOpsTypeTraitsBase2<FAuraGameplayEffectContext>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithCopy = true
+	};
+};
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "AttributeSet.h"
+#include "GameplayTagContainer.h"
 
 /** Components; Access to macros */
 #include "AbilitySystemComponent.h"
@@ -49,6 +50,45 @@ struct FEffectProperties
 
 };
 
+/** Index of each attribute in FAuraAttributeSnapshot, in the order they're declared in UAuraAttributeSet */
+enum class EAuraAttribute : uint8
+{
+	Strength,
+	Intelligence,
+	Resilience,
+	Vigor,
+	Armor,
+	ArmorPenetration,
+	BlockChance,
+	CriticalHitChance,
+	CriticalHitDamage,
+	CriticalHitResistance,
+	HealthRegeneration,
+	ManaRegeneration,
+	MaxHealth,
+	MaxMana,
+	Health,
+	Mana,
+	Num
+};
+
+/** 
+* Plain copy of every attribute value, filled by UAuraAttributeSet::GetSnapshot() in one call. Read it with Get(EAuraAttribute::X) instead of
+*  a cast and a getter per attribute. Version is the attribute set version it was taken at.
+*/
+struct FAuraAttributeSnapshot
+{
+	static constexpr int32 NumAttributes = static_cast<int32>(EAuraAttribute::Num);
+
+	float Current[NumAttributes] = {};
+	// Only filled when the snapshot was taken with bIncludeBase
+	float Base[NumAttributes] = {};
+	uint32 Version = 0;
+	bool bHasBase = false;
+
+	float Get(EAuraAttribute Attribute) const { return Current[static_cast<int32>(Attribute)]; }
+	float GetBase(EAuraAttribute Attribute) const { return Base[static_cast<int32>(Attribute)]; }
+};
 
 /**
  * 
@@ -88,6 +128,9 @@ public:
 	/** Begin UObject */
 	// Register variables for replication
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// Clients: called once after the OnReps of a replication update, to bump the snapshot version
+	virtual void PostRepNotifies() override;
 	/** End UObject */
 
 	/** Begin UAttributeSet */
@@ -105,8 +148,31 @@ public:
 	*  https://github.com/tranek/GASDocumentation/blob/master/README.md#446-postgameplayeffectexecute
 	*/
 	virtual void PostGameplayEffectExecute(const FGameplayEffectModCallbackData& Data) override;
+
+	// Any current or base value change bumps the snapshot version
+	virtual void PostAttributeChange(const FGameplayAttribute& Attribute, float OldValue, float NewValue) override;
+	virtual void PostAttributeBaseChange(const FGameplayAttribute& Attribute, float OldValue, float NewValue) const override;
 	/** End UAttributeSet */
 
+	/** 
+	* Copy every current value (and base value if bIncludeBase) into OutSnapshot. Consumers that poll (UI, AI, telemetry) can compare
+	*  GetSnapshotVersion() with the Version of their last snapshot and skip the copy, and their own work, when nothing changed.
+	*/
+	void GetSnapshot(FAuraAttributeSnapshot& OutSnapshot, bool bIncludeBase = false) const;
+
+	/** Goes up whenever an attribute changes (on the server, or through replication and prediction on clients) */
+	uint32 GetSnapshotVersion() const { return SnapshotVersion; }
+
+	/** The attribute at an EAuraAttribute index (to write values of a snapshot back) */
+	static FGameplayAttribute GetAttribute(EAuraAttribute Attribute);
+
+	/** 
+	* Registry of the attributes by gameplay tag (the Attributes.* tags in DefaultGameplayTags.ini). Widget controllers use it to find an attribute
+	*  from the tag a widget asks for, so showing one more attribute is a new entry here instead of a new delegate.
+	* Built on first use, from the native tags in FAuraGameplayTags (initialized before any gameplay code runs).
+	*/
+	static const TMap<FGameplayTag, FGameplayAttribute>& GetTagsToAttributes();
+
 	/**
 	* Since we haven't learned about Gameplay Effects yet, we'll use some functions to access the attributes to retrieve and/or set them.
 	* Note: we normally don't set them from code directly, but with gameplay effect!
@@ -263,4 +329,7 @@ public:
 private:
 	/** Fill in the data in the FEffectProperties */
 	void SetEffectProperties(const FGameplayEffectModCallbackData& Data, FEffectProperties& Props) const;
+
+	/** Mutable as PostAttributeBaseChange() is const */
+	mutable uint32 SnapshotVersion = 0;
 };
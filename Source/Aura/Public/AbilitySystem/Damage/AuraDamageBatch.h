@@ -0,0 +1,64 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FAuraAttributeSnapshot;
+
+/** What the attacker brings to every target of the batch */
+struct AURA_API FAuraDamageSource
+{
+	float BaseDamage = 0.f;
+	float ArmorPenetration = 0.f;
+	float CriticalHitChance = 0.f;
+	float CriticalHitDamage = 0.f;
+
+	/** Same seed, same targets -> same rolls, on any machine and in any order the targets are resolved */
+	uint32 Seed = 0;
+};
+
+/**
+ * Damage of one hit against many targets (AoE), resolved for all of them at once.
+ * 
+ * The target attributes the damage depends on are gathered into contiguous arrays (one per attribute), and Resolve() runs block, armor with
+ *  penetration and critical hits on 4 targets at a time with SIMD. The block and critical rolls come from a counter based hash of the seed
+ *  and the target index instead of a stateful random stream, so each target's rolls don't depend on how many targets came before it or on
+ *  which thread resolves it.
+ * The arrays are padded to a multiple of 4; NewHealth, Damage and the flags of the first Num() entries are the results.
+ */
+struct AURA_API FAuraDamageBatch
+{
+	/** Empty the batch and reserve room for NumTargets */
+	void Reset(int32 NumTargets);
+
+	/** Add a target from its attribute snapshot. Returns its index in the batch. */
+	int32 AddTarget(const FAuraAttributeSnapshot& TargetSnapshot);
+
+	int32 Num() const { return NumTargets; }
+
+	/** Resolve every target. Large batches are split in ranges resolved by worker threads (Aura.Damage.TargetsPerTask). */
+	void Resolve(const FAuraDamageSource& Source);
+
+	/** Resolve targets [Begin, End). Begin has to be a multiple of 4; End is rounded up to one, padding included. */
+	void ResolveRange(const FAuraDamageSource& Source, int32 Begin, int32 End);
+
+	/** Inputs */
+	TArray<float> Armor;
+	TArray<float> BlockChance;
+	TArray<float> CriticalHitResistance;
+	TArray<float> Health;
+	TArray<float> MaxHealth;
+
+	/** Outputs */
+	TArray<float> Damage;
+	TArray<float> NewHealth;
+	TArray<uint8> bBlocked;
+	TArray<uint8> bCriticalHit;
+
+private:
+	void AddPadding();
+	void RemovePadding();
+
+	int32 NumTargets = 0;
+};
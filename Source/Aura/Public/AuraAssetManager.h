@@ -0,0 +1,50 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/AssetManager.h"
+#include "AuraAssetManager.generated.h"
+
+struct FStreamableHandle;
+
+/**
+ * Project asset manager (set as AssetManagerClassName in DefaultEngine.ini).
+ * StartInitialLoading() runs early in engine initialization, before any world exists, which makes it the place to set up project wide data
+ *  such as the native gameplay tags.
+ *
+ * It also warms the ability system up before the first gameplay frame: the ability system globals are initialized right away instead of on
+ *  first use, and the Blueprint gameplay effect classes the characters, the effect actors and the maps reference (default attributes, potions,
+ *  crystals...) are loaded in the background while the engine and the first map load. The asset registry dependencies tell which ones, so
+ *  nothing else is loaded to find out. Once loaded, each effect's CDO and its MMC CDOs are built, so the first application in game doesn't pay
+ *  for that. These classes would be loaded by the first character or effect actor anyway, so they're kept loaded from then on.
+ */
+UCLASS()
+class AURA_API UAuraAssetManager : public UAssetManager
+{
+	GENERATED_BODY()
+
+public:
+	static UAuraAssetManager& Get();
+
+	bool IsGameplayEffectWarmupComplete() const { return bGameplayEffectWarmupComplete; }
+
+protected:
+	virtual void StartInitialLoading() override;
+
+	/** Preload and warm up the gameplay effect classes at startup */
+	UPROPERTY(Config)
+	bool bWarmupGameplayEffects = true;
+
+private:
+	void StartGameplayEffectWarmup();
+	void OnGameplayEffectClassesLoaded();
+
+	TSharedPtr<FStreamableHandle> GameplayEffectWarmupHandle;
+
+	/** Keeps the warmed up classes loaded */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UClass>> WarmedGameplayEffectClasses;
+
+	bool bGameplayEffectWarmupComplete = false;
+};
@@ -0,0 +1,53 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+/**
+ * AuraGameplayTags
+ * 
+ * Singleton containing native gameplay tags: every tag the project uses from C++ is declared here, so code reads FAuraGameplayTags::X instead
+ *  of resolving the tag from its name (RequestGameplayTag goes through the tag name table every call).
+ * InitializeNativeGameplayTags() is called by UAuraAssetManager::StartInitialLoading(), before any gameplay code runs. It also checks the native
+ *  tags against the ones declared in DefaultGameplayTags.ini, so the two lists don't drift apart.
+ */
+struct AURA_API FAuraGameplayTags
+{
+public:
+	static void InitializeNativeGameplayTags();
+
+	/** Primary Attributes */
+	static FGameplayTag Attributes_Primary_Strength;
+	static FGameplayTag Attributes_Primary_Intelligence;
+	static FGameplayTag Attributes_Primary_Resilience;
+	static FGameplayTag Attributes_Primary_Vigor;
+
+	/** Secondary Attributes */
+	static FGameplayTag Attributes_Secondary_Armor;
+	static FGameplayTag Attributes_Secondary_ArmorPenetration;
+	static FGameplayTag Attributes_Secondary_BlockChance;
+	static FGameplayTag Attributes_Secondary_CriticalHitChance;
+	static FGameplayTag Attributes_Secondary_CriticalHitDamage;
+	static FGameplayTag Attributes_Secondary_CriticalHitResistance;
+	static FGameplayTag Attributes_Secondary_HealthRegeneration;
+	static FGameplayTag Attributes_Secondary_ManaRegeneration;
+
+	/** Vital Attributes */
+	static FGameplayTag Attributes_Vital_Health;
+	static FGameplayTag Attributes_Vital_Mana;
+	static FGameplayTag Attributes_Vital_MaxHealth;
+	static FGameplayTag Attributes_Vital_MaxMana;
+
+	/** Messages */
+	static FGameplayTag Message;
+	static FGameplayTag Message_HealthCrystal;
+	static FGameplayTag Message_HealthPotion;
+	static FGameplayTag Message_ManaCrystal;
+	static FGameplayTag Message_ManaPotion;
+
+private:
+	/** Warn about native tags missing from DefaultGameplayTags.ini, and ini tags under our roots that have no native tag */
+	static void ValidateAgainstConfig(const TArray<FName>& NativeTagNames);
+};
@@ -0,0 +1,9 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Logging/LogMacros.h"
+
+/** Log category for the project (UE_LOG(LogAura, ...)) */
+DECLARE_LOG_CATEGORY_EXTERN(LogAura, Log, All);
@@ -0,0 +1,23 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+/**
+ * Low level memory tracker tags for the Aura gameplay data. Run with -llm (and -llmcsv for a CSV per minute) and they show up under Aura/ in
+ *  "stat LLMFULL" and in the LLM CSVs, next to the engine tags.
+ *  Aura/AbilitySystem     -> UAuraAbilitySystemComponent (created by AAuraPlayerState and AAuraEnemy)
+ *  Aura/AttributeSets     -> UAuraAttributeSet
+ *  Aura/ActiveEffects     -> active effect containers, filled by ApplyGameplayEffectSpecToSelf on the server
+ *  Aura/EffectSpecs       -> outgoing effect specs (MakeOutgoingSpec)
+ *  Aura/WidgetControllers -> widget controllers created by AAuraHUD
+ * LLM tracks allocations, not owners, so it can't tell a player's ASC from an enemy's. For that there's the Aura.MemReport console command,
+ *  which walks the live objects of the world and sums them per owning class.
+ */
+LLM_DECLARE_TAG_API(Aura_AbilitySystem, AURA_API);
+LLM_DECLARE_TAG_API(Aura_AttributeSets, AURA_API);
+LLM_DECLARE_TAG_API(Aura_ActiveEffects, AURA_API);
+LLM_DECLARE_TAG_API(Aura_EffectSpecs, AURA_API);
+LLM_DECLARE_TAG_API(Aura_WidgetControllers, AURA_API);
@@ -0,0 +1,33 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CountersTrace.h"
+
+/**
+ * Stats and trace counters for the Aura gameplay systems.
+ * "stat Aura" shows the per frame counters in game, and Unreal Insights (-trace=cpu,counters) shows them as counters under Aura/ next to the CPU
+ *  scopes of the same hot paths (TRACE_CPUPROFILER_EVENT_SCOPE in the ASC, attribute set, MMCs, effect actor, player controller and widget
+ *  controllers). Stat counters reset every frame on their own; the trace counters are reset by FAuraModule at the beginning of each frame.
+ */
+DECLARE_STATS_GROUP(TEXT("Aura"), STATGROUP_Aura, STATCAT_Advanced);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Effects Applied"), STAT_AuraEffectsApplied, STATGROUP_Aura, AURA_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("MMC Evaluations"), STAT_AuraMMCEvaluations, STATGROUP_Aura, AURA_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Widget Controller Broadcasts"), STAT_AuraWidgetBroadcasts, STATGROUP_Aura, AURA_API);
+
+TRACE_DECLARE_INT_COUNTER_EXTERN(AuraEffectsApplied);
+TRACE_DECLARE_INT_COUNTER_EXTERN(AuraMMCEvaluations);
+TRACE_DECLARE_INT_COUNTER_EXTERN(AuraWidgetBroadcasts);
+
+namespace AuraStats
+{
+	/** Called at the beginning of every frame */
+	void ResetFrameCounters();
+}
+
+#define AURA_COUNT_EFFECT_APPLIED() { INC_DWORD_STAT(STAT_AuraEffectsApplied); TRACE_COUNTER_INCREMENT(AuraEffectsApplied); }
+#define AURA_COUNT_MMC_EVALUATION() { INC_DWORD_STAT(STAT_AuraMMCEvaluations); TRACE_COUNTER_INCREMENT(AuraMMCEvaluations); }
+#define AURA_COUNT_WIDGET_BROADCASTS(Count) { INC_DWORD_STAT_BY(STAT_AuraWidgetBroadcasts, Count); TRACE_COUNTER_ADD(AuraWidgetBroadcasts, Count); }
@@ -31,6 +31,8 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	/** Hibernates the ability system state when the enemy's level streams out (UAuraEnemyHibernationSubsystem) */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	/** Begin AuraCharacterBase */
 	void InitAbilityActorInfo() override;
@@ -13,5 +13,22 @@ UCLASS()
 class AURA_API AAuraGameModeBase : public AGameModeBase
 {
 	GENERATED_BODY()
-	
+
+public:
+	/** Begin AGameModeBase */
+	virtual void PostLogin(APlayerController* NewPlayer) override;
+	virtual void Logout(AController* Exiting) override;
+	/** End AGameModeBase */
+
+protected:
+	/**
+	* Load the player's progression snapshot when they join, autosave it while they play (UAuraAutosaveSubsystem) and save it when they leave
+	*  (see AAuraPlayerState::SaveSnapshot).
+	*/
+	UPROPERTY(EditDefaultsOnly, Category = "Save")
+	bool bPersistPlayerSnapshots = true;
+
+private:
+	/** One slot per player: their unique net id, or their name when there's none (PIE, LAN without online subsystem) */
+	static FString GetSnapshotSlotName(const APlayerState* PlayerState);
 };
@@ -0,0 +1,101 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+#define AURA_ATTRIBUTE_NET_PROFILER !UE_BUILD_SHIPPING
+
+class UAttributeSet;
+class UNetConnection;
+struct FGameplayAttributeData;
+
+/**
+ * Records attribute replication per connection, per owning class (player state or enemy) and per attribute, as totals and rates over the
+ *  recording.
+ *
+ * Server side, UAuraReplicationGraph reports every actor it replicated to a connection in a frame. The profiler keeps the attribute values last
+ *  sent to that connection (like the rep layout's shadow state) and counts each changed attribute as an update. Its bytes are what the rep layout
+ *  writes for it: the property handle plus each changed member (base and current value), measured by net serializing them with the float
+ *  property's NetSerializeItem. The actor and subobject headers are shared with other properties and aren't counted. The first replication of a
+ *  set to a connection only seeds its shadow, since it may have been sent before the recording started.
+ * Client side, every OnRep in UAuraAttributeSet goes through AURA_ATTRIBUTE_REPNOTIFY and is counted as a received update. Unchanged OnReps are
+ *  the ones where the received value equals the old one: they only happen because the attributes use REPNOTIFY_Always, and only the client can
+ *  see them.
+ * Server rows have the remote address and player name as their connection; client rows have the client world ("Client 1 (received)").
+ *
+ * Console commands:
+ *  Aura.Net.AttributeProfiler.Start
+ *  Aura.Net.AttributeProfiler.Stop -> writes Saved/Profiling/AuraAttributeNet/AttributeNet_<date>.csv, sorted so two builds can be diffed
+ */
+class AURA_API FAuraAttributeNetProfiler
+{
+public:
+	static FAuraAttributeNetProfiler& Get();
+
+	void Start();
+	void Stop();
+	bool IsRunning() const { return bRunning; }
+
+	/** Server: AttributeSet's owner was replicated to Connection in replication frame RepFrame */
+	void RecordReplicatedActor(UNetConnection* Connection, const UAttributeSet* AttributeSet, uint32 RepFrame);
+
+	/** Client: called from the attribute set OnReps */
+	void RecordRepNotify(const UAttributeSet* AttributeSet, FName AttributeName, const FGameplayAttributeData& OldValue, const FGameplayAttributeData& NewValue);
+
+private:
+	struct FRowKey
+	{
+		FString Connection;
+		FName OwnerClass;
+		FName Attribute;
+
+		bool operator==(const FRowKey& Other) const
+		{
+			return OwnerClass == Other.OwnerClass && Attribute == Other.Attribute && Connection == Other.Connection;
+		}
+
+		friend uint32 GetTypeHash(const FRowKey& Key)
+		{
+			return HashCombine(GetTypeHash(Key.Connection), HashCombine(GetTypeHash(Key.OwnerClass), GetTypeHash(Key.Attribute)));
+		}
+	};
+
+	struct FRowCounters
+	{
+		int32 Updates = 0;
+		int64 Bits = 0;
+		int32 UnchangedOnReps = 0;
+	};
+
+	/** What a connection last received from one attribute set */
+	struct FConnectionShadow
+	{
+		uint32 LastRepFrame = MAX_uint32;
+		TArray<float> BaseValues;
+		TArray<float> CurrentValues;
+	};
+
+	void WriteCSV(double Duration) const;
+
+	TMap<FRowKey, FRowCounters> Rows;
+	TMap<TPair<TObjectKey<UNetConnection>, TObjectKey<UAttributeSet>>, FConnectionShadow> Shadows;
+	double StartTime = 0.0;
+	bool bRunning = false;
+};
+
+/** GAMEPLAYATTRIBUTE_REPNOTIFY plus reporting to the profiler */
+#if AURA_ATTRIBUTE_NET_PROFILER
+#define AURA_ATTRIBUTE_REPNOTIFY(ClassName, PropertyName, OldValue) \
+	{ \
+		FAuraAttributeNetProfiler& Profiler = FAuraAttributeNetProfiler::Get(); \
+		if (Profiler.IsRunning()) \
+		{ \
+			Profiler.RecordRepNotify(this, GET_MEMBER_NAME_CHECKED(ClassName, PropertyName), OldValue, PropertyName); \
+		} \
+	} \
+	GAMEPLAYATTRIBUTE_REPNOTIFY(ClassName, PropertyName, OldValue)
+#else
+#define AURA_ATTRIBUTE_REPNOTIFY(ClassName, PropertyName, OldValue) GAMEPLAYATTRIBUTE_REPNOTIFY(ClassName, PropertyName, OldValue)
+#endif
@@ -0,0 +1,101 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "AuraNetLatencyProbeComponent.generated.h"
+
+/** Forward Declaration */
+class UAbilitySystemComponent;
+class UGameplayEffect;
+class UOverlayWidgetController;
+struct FOnAttributeChangeData;
+
+/**
+ * Measures how long an attribute change takes to go from the server to this client.
+ *
+ * The client asks the server to apply ProbeEffectClass to a target (our own player, whose ASC lives on the player state with Mixed replication, or
+ *  the enemy under the cursor, whose ASC replicates with Minimal). The server applies it right away, bypassing the application queue
+ *  (UAuraAbilitySystemComponent::ApplyGameplayEffectSpecToSelfUnqueued), and the client waits for the Health change delegate, which is fired
+ *  from OnRep_Health. Each sample is the time between sending the request and receiving the change, minus half the round trip time reported by
+ *  the player state, i.e. roughly the time from the server application to the client OnRep.
+ * When the target is our own player, a second sample is taken when the overlay widget controller broadcasts the new Health (OnHealthChanged),
+ *  which includes the overlay's coalescing of attribute broadcasts.
+ *
+ * Network conditions come from the packet simulation profiles in DefaultEngine.ini (NetEmulation.PktEmulationProfile Average/Bad/Lossy), and the
+ *  setup for several clients in one process is PIE with Net Mode "Play As Client", Number of Players > 1 and "Run Under One Process".
+ * To start a probe use the console command on the player controller: AuraProbeLatency <NumSamples> <bTargetEnemy>
+ *
+ * ProbeEffectClass should be an instant GE with an additive Health modifier using a Set By Caller magnitude named "LatencyProbe". The server
+ *  alternates between -1 and +1 so the value always changes (an unchanged value doesn't replicate) and Health ends where it started. The
+ *  target's regeneration is suspended during the probe, so the +1 never gets clamped at MaxHealth. The client only takes a Health change of
+ *  exactly that step as the sample, so damage landing in between isn't mistaken for it.
+ */
+UCLASS(ClassGroup = (Aura), meta = (BlueprintSpawnableComponent))
+class AURA_API UAuraNetLatencyProbeComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UAuraNetLatencyProbeComponent();
+
+	/** Start sending NumSamples probes to Target. Target has to implement IAbilitySystemInterface. */
+	void StartProbe(int32 NumSamples, AActor* Target);
+
+protected:
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Latency Probe")
+	TSubclassOf<UGameplayEffect> ProbeEffectClass;
+
+	/** Time between two samples. It should be longer than the worst expected latency, so samples don't overlap. */
+	UPROPERTY(EditDefaultsOnly, Category = "Latency Probe")
+	float SampleInterval = 0.5f;
+
+	/** A sample that hasn't arrived after this long is counted as lost */
+	UPROPERTY(EditDefaultsOnly, Category = "Latency Probe")
+	float SampleTimeout = 2.f;
+
+private:
+	UFUNCTION(Server, Reliable)
+	void ServerApplyProbeEffect(AActor* Target, int32 InSampleIndex);
+
+	/** Suspends the target's regeneration for the duration of the probe */
+	UFUNCTION(Server, Reliable)
+	void ServerSetProbeActive(AActor* Target, bool bActive);
+
+	UFUNCTION()
+	void OnOverlayHealthChanged(float NewValue);
+
+	void SendNextSample();
+	void OnProbedHealthChanged(const FOnAttributeChangeData& Data);
+	void FinishProbe();
+	void StopListening();
+
+	/** Health change the server applies for a sample: -1, +1, -1... */
+	static float GetProbeMagnitude(int32 InSampleIndex) { return InSampleIndex % 2 == 0 ? -1.f : 1.f; }
+
+	TWeakObjectPtr<UAbilitySystemComponent> ProbedASC;
+	TWeakObjectPtr<AActor> ProbedActor;
+	FDelegateHandle HealthChangedHandle;
+	TWeakObjectPtr<UOverlayWidgetController> ProbedOverlayController;
+	FTimerHandle SampleTimerHandle;
+
+	int32 SamplesRemaining = 0;
+	int32 SampleIndex = 0;
+	int32 LostSamples = 0;
+	bool bAwaitingSample = false;
+	double SampleSentTime = 0.0;
+	double SampleOneWayTime = 0.0;
+	float ExpectedHealthDelta = 0.f;
+
+	/** Overlay sample: the Health value the ASC delegate received, waiting for the overlay to broadcast it */
+	bool bAwaitingOverlaySample = false;
+	float ExpectedOverlayHealth = 0.f;
+	int32 LostOverlaySamples = 0;
+
+	/** Latencies in seconds, to the ASC delegate and to the overlay broadcast */
+	TArray<double> Samples;
+	TArray<double> OverlaySamples;
+};
@@ -0,0 +1,129 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "AuraReplicationGraph.generated.h"
+
+/** Forward Declaration */
+class UReplicationGraphNode_GridSpatialization2D;
+class UReplicationGraphNode_ActorList;
+class UReplicationGraphNode_AlwaysRelevant_ForConnection;
+class AAuraEnemy;
+
+/**
+* How a replicated class gets routed into the graph. Every replicated actor class resolves to one of these when it's first seen (the lookup walks
+*  up the class hierarchy, so a BP enemy uses the AAuraEnemy policy).
+*  - NotRouted: the actor is handled elsewhere (eg the owning connection node picks up the player controller and its pawn by itself).
+*  - RelevantAllConnections: goes into a global list that every connection replicates (game state, player states).
+*  - Spatialize_Static: goes into the grid once and never moves cells (pickups, effect actors placed in the level).
+*  - Spatialize_Dynamic: goes into the grid and gets its cell updated every frame (enemies, player pawns).
+*  - Spatialize_Dormancy: like Static while dormant, like Dynamic while awake.
+*/
+UENUM()
+enum class EAuraClassRepNodeMapping : uint32
+{
+	NotRouted,
+	RelevantAllConnections,
+	Spatialize_Static,
+	Spatialize_Dynamic,
+	Spatialize_Dormancy
+};
+
+/**
+ * Replication graph for Aura. Instead of every connection checking relevancy against every actor, actors are routed once into nodes:
+ *  - a 2D spatial grid for enemies, effect actors and pawns, so a connection only considers the cells around its view location;
+ *  - a dedicated list for player states, since they hold the ASC and AttributeSet of each player and must stay relevant to everyone;
+ *  - an always relevant list for the game state and other global info actors;
+ *  - a node per connection for owner only data (the player controller and the actor it's viewing).
+ *
+ * It's enabled through ReplicationDriverClassName under the IpNetDriver section in DefaultEngine.ini. The grid settings are config variables, so
+ *  they can be tweaked per map size without rebuilding.
+ *
+ * Load test, on the server (dedicated with -nullrhi for a headless run, clients connected the same way):
+ *  Aura.RepGraph.LoadTest <NumEnemies> [NumFrames = 300] [Spacing = 500]
+ * It spawns NumEnemies enemies in a square around the first player (or the origin), times ServerReplicateActors for NumFrames frames, then logs
+ *  the number of connections, the actors in each node and the average and max replication cost, and destroys the enemies.
+ *
+ * While FAuraAttributeNetProfiler is recording, every frame reports which attribute set owners were replicated to which connection.
+ */
+UCLASS(Transient, Config = Engine)
+class AURA_API UAuraReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	UAuraReplicationGraph();
+
+	/** Begin UReplicationGraph */
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+	/** End UReplicationGraph */
+
+	/** Start the load test described above. Does nothing if one is already running. */
+	void StartLoadTest(int32 NumEnemies, int32 NumFrames, float Spacing);
+
+	/** Size of each grid cell in cm. Bigger cells mean fewer cells to gather but more actors per cell. */
+	UPROPERTY(Config)
+	float GridCellSize = 10000.f;
+
+	/** Bias for the grid origin so that the whole map sits in positive cell coordinates (the grid can't go below zero). */
+	UPROPERTY(Config)
+	float SpatialBiasX = -150000.f;
+
+	UPROPERTY(Config)
+	float SpatialBiasY = -200000.f;
+
+	/** Distance used when deciding if destruction infos should be sent to a connection. */
+	UPROPERTY(Config)
+	float DestructionInfoMaxDist = 30000.f;
+
+	/** When false, player pawns are routed as owner/always relevant instead of going through the grid. */
+	UPROPERTY(Config)
+	bool bSpatializePlayerPawns = true;
+
+	/** Enemy spawned by the load test. Falls back to AAuraEnemy when unset. */
+	UPROPERTY(Config)
+	TSoftClassPtr<AAuraEnemy> LoadTestEnemyClass;
+
+protected:
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_GridSpatialization2D> GridNode;
+
+	/** Dedicated node for the player states (and their ASC / AttributeSet subobjects) */
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_ActorList> PlayerStateNode;
+
+	/** Game state and any other actor that is relevant to every connection */
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_ActorList> AlwaysRelevantNode;
+
+private:
+	/** Class -> routing policy. TClassMap walks up the hierarchy and caches the result for classes it hasn't seen yet. */
+	TClassMap<EAuraClassRepNodeMapping> ClassRepNodePolicies;
+
+	EAuraClassRepNodeMapping GetMappingPolicy(UClass* Class);
+
+	/** Policy for classes that weren't explicitly mapped in InitGlobalActorClassSettings(), based on the actor's CDO replication settings */
+	EAuraClassRepNodeMapping GetDefaultMappingPolicy(const AActor* ActorCDO) const;
+
+	struct FLoadTest
+	{
+		TArray<TWeakObjectPtr<AActor>> Enemies;
+		int32 NumFrames = 0;
+		int32 FramesRemaining = 0;
+		double TotalSeconds = 0.0;
+		double MaxSeconds = 0.0;
+	};
+	FLoadTest LoadTest;
+
+	void FinishLoadTest();
+
+	/** Feeds the attribute net profiler with this frame's replications */
+	void RecordReplicatedAttributes();
+};
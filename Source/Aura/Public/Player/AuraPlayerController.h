@@ -10,6 +10,7 @@ class UInputMappingContext;
 class UInputAction;
 struct FInputActionValue;
 class IEnemyInterface;
+class UAuraNetLatencyProbeComponent;
 
 /**
  * 
@@ -32,6 +33,13 @@ public:
 	*/
 	virtual void PlayerTick(float DeltaTime) override;
 
+	/** 
+	* Console command to measure attribute replication latency (see UAuraNetLatencyProbeComponent).
+	* bTargetEnemy probes the enemy under the cursor (Minimal replication), otherwise our own player (Mixed replication).
+	*/
+	UFUNCTION(Exec)
+	void AuraProbeLatency(int32 NumSamples = 20, bool bTargetEnemy = false);
+
 protected:
 	virtual void BeginPlay() override;
 	virtual void SetupInputComponent() override;
@@ -52,6 +60,9 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Input")
 	TObjectPtr<UInputAction> MoveAction;
 
+	UPROPERTY(VisibleAnywhere, Category = "Debug")
+	TObjectPtr<UAuraNetLatencyProbeComponent> LatencyProbe;
+
 	/** Input Actions Callback Functions */
 	// Since MoveAction is an IA that provides data, this function must have an input parameter of type FInputActionValue (forward declared struct)
 	void Move(const FInputActionValue& InputActionValue);
@@ -59,4 +70,13 @@ private:
 	// Trace under the cursor
 	void CursorTrace();
 
+	/** 
+	* With FastReplication on (DefaultGameplayTags.ini), gameplay tags are sent as an index into a dictionary every machine builds from its own
+	*  tag list. If a client's list differs from the server's, indices silently resolve to the wrong tags (eg a Message.HealthPotion turning into
+	*  a Message.ManaCrystal). So the local client sends the hash of its dictionary and the server compares it against its own.
+	*/
+	void ValidateGameplayTagNetIndex();
+
+	UFUNCTION(Server, Reliable)
+	void ServerReportGameplayTagNetIndexHash(uint32 ClientHash);
 };
@@ -14,6 +14,8 @@
 class UAbilitySystemComponent;
 class UAttributeSet;
 
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnPlayerLevelChanged, int32 /*NewLevel*/);
+
 /** 
 * This is the most important class for shared information about a specific player. It's meant to hold current info about the player, and each player
 *  has their own PS. https://cedric-neukirchen.net/docs/multiplayer-compendium/common-classes/playerstate/
@@ -40,6 +42,26 @@ public:
 	UAttributeSet* GetAttributeSet() const { return AttributeSet; }
 	FORCEINLINE int32 GetPlayerLevel() const { return Level; }  
 
+	/**
+	* Server only. Replicates the new level, and lets the ASC refresh the level cached in its effect contexts (one recalculation of every level
+	*  dependent magnitude, see UAuraAbilitySystemComponent::SetCombatLevel).
+	*/
+	void SetLevel(int32 InLevel);
+
+	/** Broadcast on the server from SetLevel and on clients from OnRep_Level */
+	FOnPlayerLevelChanged OnLevelChangedDelegate;
+
+	/**
+	* Persistence of the player progression (level, attributes, active effects), server only. See AuraSnapshot for the format.
+	* SaveSnapshot captures on the game thread and writes the file on a background thread.
+	* LoadSnapshot waits for the pending snapshot writes, maps and validates the slot file (and reads its autosave journal), and keeps a copy of
+	*  them until the avatar's ability actor info is set, where RestorePendingSnapshot puts them back on the ASC instead of the default attribute
+	*  effects. It returns false when there's nothing to restore.
+	*/
+	void SaveSnapshot(const FString& SlotName) const;
+	bool LoadSnapshot(const FString& SlotName);
+	bool RestorePendingSnapshot();
+
 protected:
 	/** 
 	* Declare those pointers here since our player controlled character won't have them.
@@ -51,6 +73,9 @@ protected:
 	TObjectPtr<UAttributeSet> AttributeSet;
 
 private:
+	/** Loaded by LoadSnapshot, waiting for RestorePendingSnapshot */
+	TArray<uint8> PendingSnapshot;
+	TArray<uint8> PendingJournal;
 
 	/** 
 	* Level is going to be replicated. It needs to have its own Rep Notify so we can show it in the HUD, and broadcast it whenever it's replicated!
@@ -66,4 +91,6 @@ private:
 
 	UFUNCTION()
 	void OnRep_Level(int32 OldLevel);
+
+	void HandleLevelChanged();
 };
@@ -0,0 +1,139 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+class UAbilitySystemComponent;
+
+/**
+ * Binary snapshot of an Aura ability system: level, base value of every attribute and the active duration/infinite effects.
+ *
+ * Layout (little endian, every block 4 byte aligned, so a memory mapped file can be read in place):
+ *  FAuraSnapshotHeader
+ *  float                 AttributeBase[NumAttributes]   (EAuraAttribute order)
+ *  FAuraSnapshotEffect   Effects[NumEffects]
+ *  UTF-8                 Strings[StringBytes]           (effect class paths, referenced by offset)
+ *
+ * Version goes up with every change of the layout or of EAuraAttribute; older versions are rejected instead of half read.
+ *
+ * A slot is the snapshot plus an append-only journal (<SlotName>.aurajournal) of the changes made since it was written (see
+ *  UAuraAutosaveSubsystem). Each journal record is an FAuraJournalRecordHeader followed by its FAuraJournalAttribute entries. Loading a slot
+ *  restores the snapshot, then replays the journal; writing a new snapshot of the slot deletes the journal.
+ */
+struct FAuraSnapshotHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x4E535541; // "AUSN"
+	static constexpr uint16 CurrentVersion = 1;
+
+	uint32 Magic = ExpectedMagic;
+	uint16 Version = CurrentVersion;
+	uint16 NumAttributes = 0;
+	uint32 NumEffects = 0;
+	uint32 StringBytes = 0;
+	int32 Level = 0;
+	uint32 Reserved = 0;
+};
+
+struct FAuraSnapshotEffect
+{
+	uint32 ClassPathOffset = 0;
+	uint32 ClassPathLength = 0;
+	float Level = 1.f;
+	/** Seconds left, or -1 for infinite effects */
+	float TimeRemaining = -1.f;
+	int32 StackCount = 1;
+};
+
+struct FAuraJournalRecordHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x524A5541; // "AUJR"
+	static constexpr uint16 CurrentVersion = 1;
+
+	uint32 Magic = ExpectedMagic;
+	uint16 Version = CurrentVersion;
+	uint16 NumAttributes = 0;
+	int32 Level = 0;
+};
+
+struct FAuraJournalAttribute
+{
+	uint32 Index = 0;
+	float BaseValue = 0.f;
+};
+
+/** Pointers into a validated snapshot. Only valid as long as the bytes it was parsed from. */
+struct FAuraSnapshotView
+{
+	const FAuraSnapshotHeader* Header = nullptr;
+	const float* AttributeBase = nullptr;
+	const FAuraSnapshotEffect* Effects = nullptr;
+	const UTF8CHAR* Strings = nullptr;
+
+	FString GetEffectClassPath(const FAuraSnapshotEffect& Effect) const;
+};
+
+namespace AuraSnapshot
+{
+	/**
+	 * Write the snapshot of an ASC (with an Aura attribute set) into OutBytes. Game thread.
+	 * Infinite effects are only kept if they're marked as applied to self in their Aura context (the default attributes, and effects restored
+	 *  from a snapshot): the ones coming from other sources (effect actors) are applied again by their source, and would never be removed if
+	 *  the snapshot brought them back.
+	 */
+	AURA_API void Capture(const UAbilitySystemComponent& AbilitySystemComponent, int32 Level, TArray<uint8>& OutBytes);
+
+	/** Check the header and every size and offset. OutView points into Bytes. */
+	AURA_API bool Parse(TConstArrayView<uint8> Bytes, FAuraSnapshotView& OutView);
+
+	/**
+	 * Put the attribute base values and the effects of a snapshot back on an ASC, without going through the default attribute effects. Server only.
+	 * The level isn't applied here: it lives on the owner (player state, enemy) and has to be set before, so the restored effects are made with it.
+	 */
+	AURA_API bool Restore(UAbilitySystemComponent& AbilitySystemComponent, const FAuraSnapshotView& View);
+
+	/**
+	 * Apply the journal records of a slot after its snapshot was restored: attribute base values, and the level through OutLevel (left as is
+	 *  when the journal has no record). Reading stops at the first incomplete record, i.e. the one being written if the server went down.
+	 */
+	AURA_API void ReplayJournal(UAbilitySystemComponent& AbilitySystemComponent, TConstArrayView<uint8> JournalBytes, int32& OutLevel);
+
+	/** Append a journal record (header + entries) to OutBytes */
+	AURA_API void WriteJournalRecord(int32 Level, TConstArrayView<FAuraJournalAttribute> Attributes, TArray<uint8>& OutBytes);
+
+	/**
+	 * Background writes of a slot. They're all done one after the other, in the order they were requested, so a journal record requested
+	 *  after a snapshot always ends up after it.
+	 * WriteSnapshotAsync replaces the snapshot and deletes the journal, which the snapshot contains from then on.
+	 */
+	AURA_API void WriteSnapshotAsync(TArray<uint8>&& Bytes, const FString& SlotName);
+	AURA_API void AppendJournalAsync(TArray<uint8>&& Bytes, const FString& SlotName);
+
+	/** Block until every requested write is on disk. Call before reading a slot that may have just been saved (logout then login). */
+	AURA_API void WaitForPendingWrites();
+
+	/** Saved/SaveGames/Aura/<SlotName>.aurasnap and .aurajournal */
+	AURA_API FString GetSlotPath(const FString& SlotName);
+	AURA_API FString GetJournalPath(const FString& SlotName);
+}
+
+/**
+ * Snapshot file opened for reading. The file is memory mapped when the platform supports it, so validating it doesn't copy it; otherwise it's
+ *  read into memory. Keep it only as long as it's read: a mapped file can't be replaced by a save on every platform.
+ */
+class AURA_API FAuraSnapshotFile
+{
+public:
+	FAuraSnapshotFile();
+	~FAuraSnapshotFile();
+
+	bool Open(const FString& FilePath);
+	TConstArrayView<uint8> GetBytes() const;
+
+private:
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray<uint8> LoadedBytes;
+};
@@ -0,0 +1,98 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+
+/** FGameplayAttribute, FAuraAttributeSnapshot */
+#include "AbilitySystem/AuraAttributeSet.h"
+
+#include "AuraAutosaveSubsystem.generated.h"
+
+/** Forward Declaration */
+class AAuraPlayerState;
+
+/**
+ * Incremental autosave of the player progression, on the server.
+ *
+ * Registered players are marked dirty by the change delegates of their persistent attributes, their level change delegate and their active
+ *  effects being added or removed. Every CheckpointInterval, each dirty player whose only changes are attribute base values or level gets a
+ *  journal record with just the values that changed since their last checkpoint (a few bytes), appended to their slot journal on the background
+ *  write pipe. Players whose active effects changed, or who have no snapshot yet, get a full snapshot instead.
+ * Every CompactionInterval, players with a journal are compacted: a full snapshot replaces the old one and the journal. Compactions are spread
+ *  over frames (MaxCompactionsPerTick), so the whole server never saves in the same frame.
+ * The game mode registers players on login and does the final full save on logout (see AuraSnapshot for the slot format).
+ */
+UCLASS(Config = Game)
+class AURA_API UAuraAutosaveSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** bHasSnapshot: the slot already has a snapshot (the player was loaded from it), so their first checkpoint can be a journal record */
+	void RegisterPlayer(AAuraPlayerState* PlayerState, const FString& SlotName, bool bHasSnapshot);
+	void UnregisterPlayer(AAuraPlayerState* PlayerState);
+
+	/** Begin FTickableGameObject */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/** End FTickableGameObject */
+
+protected:
+	/** Begin UWorldSubsystem */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+	/** End UWorldSubsystem */
+
+	/** Seconds between two checkpoints of the dirty players */
+	UPROPERTY(Config)
+	float CheckpointInterval = 10.f;
+
+	/** Seconds between two compactions of the journals into snapshots */
+	UPROPERTY(Config)
+	float CompactionInterval = 300.f;
+
+	/** A journal with this many records is compacted at the next checkpoint, without waiting for the compaction interval */
+	UPROPERTY(Config)
+	int32 MaxJournalRecords = 64;
+
+	/** Full snapshots written per frame at most (compactions and checkpoints that need one). The rest waits for the next frames. */
+	UPROPERTY(Config)
+	int32 MaxCompactionsPerTick = 2;
+
+private:
+	struct FAutosaveEntry
+	{
+		TWeakObjectPtr<AAuraPlayerState> PlayerState;
+		FString SlotName;
+
+		/** What the slot (snapshot + journal) has, to find the values that changed */
+		float SavedBaseValues[FAuraAttributeSnapshot::NumAttributes] = {};
+		int32 SavedLevel = 0;
+
+		int32 JournalRecords = 0;
+		bool bHasSnapshot = false;
+		bool bDirty = false;
+		bool bEffectsDirty = false;
+		bool bCompactionQueued = false;
+
+		TArray<TPair<FGameplayAttribute, FDelegateHandle>> AttributeHandles;
+		FDelegateHandle LevelChangedHandle;
+		FDelegateHandle EffectAddedHandle;
+		FDelegateHandle EffectRemovedHandle;
+	};
+
+	void MarkDirty(TObjectKey<AAuraPlayerState> Key, bool bEffectsChanged);
+	void Checkpoint();
+	void WriteJournalRecord(FAutosaveEntry& Entry);
+	void WriteSnapshot(FAutosaveEntry& Entry);
+	void UnbindEntry(FAutosaveEntry& Entry);
+	void ProcessCompactionQueue();
+
+	TMap<TObjectKey<AAuraPlayerState>, FAutosaveEntry> Entries;
+	TArray<TObjectKey<AAuraPlayerState>> CompactionQueue;
+	float TimeSinceCheckpoint = 0.f;
+	float TimeSinceCompaction = 0.f;
+};
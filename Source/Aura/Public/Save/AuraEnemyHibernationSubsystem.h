@@ -0,0 +1,46 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AuraEnemyHibernationSubsystem.generated.h"
+
+/** Forward Declaration */
+class AAuraEnemy;
+class UAbilitySystemComponent;
+
+/**
+ * Keeps the ability system state of enemies whose level streamed out, on the server.
+ *
+ * When a placed enemy is removed from the world (its streaming level unloads), its level, attribute base values and active effects are
+ *  captured into an AuraSnapshot blob (a few hundred bytes) keyed by the enemy's path in its level. When the level streams back in and the
+ *  same enemy sets up its ability actor info, the blob is restored on its ASC and dropped, so the enemy comes back as it was left (wounded,
+ *  buffed...) without keeping the actor alive in between.
+ * Enemies spawned at runtime have no stable path to come back to, so they aren't hibernated.
+ */
+UCLASS()
+class AURA_API UAuraEnemyHibernationSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Capture the enemy's state. Called from EndPlay when the enemy is removed from the world. */
+	void Hibernate(const AAuraEnemy* Enemy, const UAbilitySystemComponent& AbilitySystemComponent, int32 Level);
+
+	/** Restore the enemy's state if it was hibernated, passing the saved level to SetLevel first. Returns false when there was nothing to restore. */
+	bool Rehydrate(const AAuraEnemy* Enemy, UAbilitySystemComponent& AbilitySystemComponent, TFunctionRef<void(int32 /*Level*/)> SetLevel);
+
+	int32 GetNumHibernated() const { return Blobs.Num(); }
+
+protected:
+	/** Begin UWorldSubsystem */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	/** End UWorldSubsystem */
+
+private:
+	/** Path of a placed enemy in its level, the same every time the level is loaded. None for enemies spawned at runtime. */
+	static FSoftObjectPath GetHibernationKey(const AAuraEnemy* Enemy);
+
+	TMap<FSoftObjectPath, TArray<uint8>> Blobs;
+};
@@ -4,14 +4,22 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/HUD.h"
+#include "Blueprint/UserWidgetPool.h"
+#include "GameplayTagContainer.h"
+
+/** FUIWidgetRow: taken by ShowMessageWidget and received by value from MessageWidgetRowDelegate */
+#include "UI/WidgetController/OverlayWidgetController.h"
+
 #include "AuraHUD.generated.h"
 
 /** Forward Declaration */
 class UAuraUserWidget;
 class UOverlayWidgetController;
+class UAttributeMenuWidgetController;
 struct FWidgetControllerParams;
 class UAbilitySystemComponent;
 class UAttributeSet;
+struct FStreamableHandle;
 
 /**
  * A HUD is a way of projecting information in form of text, images, animations etc, to inform the player what's happening to its character, or
@@ -39,22 +47,114 @@ public:
 	*/
 	UOverlayWidgetController* GetOverlayWidgetController(const FWidgetControllerParams& WCParams);
 
-	// Construct the widget, the widget controller, set the widget's widget controller and add it to the viewport
+	/** The overlay widget controller if it was created already, nullptr otherwise */
+	UOverlayWidgetController* GetOverlayWidgetController() const { return OverlayWidgetController; }
+
+	/** 
+	* Same as GetOverlayWidgetController, for the attribute menu. It uses the params InitOverlay() received, so the menu can get it from BP once the
+	*  overlay has been initialized.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "WidgetController")
+	UAttributeMenuWidgetController* GetAttributeMenuWidgetController();
+
+	/** 
+	* Construct the widget, the widget controller, set the widget's widget controller and add it to the viewport.
+	* None of it happens in this frame: the widget and controller classes are streamed asynchronously, then the controller, the widget and adding
+	*  it to the viewport are done one per frame (see OnOverlayClassesLoaded). The controller holds its broadcasts until the widget is listening.
+	*/
 	void InitOverlay(APlayerController* PC, APlayerState* PS, UAbilitySystemComponent* ASC, UAttributeSet* AS);
 
+	/** 
+	* Show the message widget of a row broadcast by MessageWidgetRowDelegate. The HUD binds to the delegate once the overlay widget has its
+	*  controller, unless the overlay BP still binds it itself (then the BP keeps creating its own widgets, and the HUD doesn't show them twice).
+	* Widgets come from a pool (one per widget class) instead of being created and garbage collected for every pickup. If a message with the same
+	*  tag is still on screen and was shown less than MessageCoalesceWindow ago, that widget is reused and its count goes up (eg "+Health" x5).
+	* A widget goes back to the pool when its animations finish, or after MessageWidgetLifetime if it has none.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Messages")
+	UAuraUserWidget* ShowMessageWidget(const FUIWidgetRow& Row);
+
+	/** Give a message widget back to the pool before its lifetime is over (eg when its animation finished) */
+	UFUNCTION(BlueprintCallable, Category = "Messages")
+	void ReleaseMessageWidget(UAuraUserWidget* MessageWidget);
+
 protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Max number of message widgets on screen. Showing one more recycles the oldest. */
+	UPROPERTY(EditDefaultsOnly, Category = "Messages", meta = (ClampMin = "1"))
+	int32 MaxLiveMessageWidgets = 5;
+
+	/** Max seconds (game time) a message widget stays on screen before it goes back to the pool, for widgets whose animations never finish */
+	UPROPERTY(EditDefaultsOnly, Category = "Messages")
+	float MessageWidgetLifetime = 3.f;
 
+	/** Identical messages arriving within this window are merged into the widget already on screen */
+	UPROPERTY(EditDefaultsOnly, Category = "Messages")
+	float MessageCoalesceWindow = 0.5f;
 
 private:
-	// As we need to know which class we need to create the widget, we gotta store it in a UClass kind of pointer variable. Set it in BP.
+	/** 
+	* As we need to know which class we need to create the widget, we gotta store it in a UClass kind of pointer variable. Set it in BP.
+	* It's a soft reference, so the overlay BP (and everything it references) isn't loaded along with the HUD but streamed in by InitOverlay().
+	*/
 	UPROPERTY(EditAnywhere)
-	TSubclassOf<UAuraUserWidget> OverlayWidgetClass;
+	TSoftClassPtr<UAuraUserWidget> OverlayWidgetClass;
 
 	// Store the overlay widget controller
 	UPROPERTY()
 	TObjectPtr<UOverlayWidgetController> OverlayWidgetController;
 
-	// To create the overlay widget controller, we need a UClass of type UOverlayWidgetController
-	UPROPERTY(EditAnywhere) // since we need to set it from BP
-	TSubclassOf<UOverlayWidgetController> OverlayWidgetControllerClass;
+	/** 
+	* To create the overlay widget controller, we need a UClass of type UOverlayWidgetController. Set it from BP.
+	* Also a soft reference: the controller BP references the message data table, which references the message widgets, so streaming this class
+	*  streams them as well.
+	*/
+	UPROPERTY(EditAnywhere)
+	TSoftClassPtr<UOverlayWidgetController> OverlayWidgetControllerClass;
+
+	UPROPERTY()
+	TObjectPtr<UAttributeMenuWidgetController> AttributeMenuWidgetController;
+
+	UPROPERTY(EditAnywhere)
+	TSubclassOf<UAttributeMenuWidgetController> AttributeMenuWidgetControllerClass;
+
+	/** Bound to OverlayWidgetController->MessageWidgetRowDelegate */
+	UFUNCTION()
+	void HandleMessageWidgetRow(FUIWidgetRow Row);
+
+	/** Overlay creation, spread over several frames */
+	void OnOverlayClassesLoaded();
+	void CreateOverlayWidget();
+	void ShowOverlayWidget();
+
+	/** Params of the latest InitOverlay() call, used once the overlay classes are loaded and by the other widget controllers */
+	UPROPERTY(Transient)
+	FWidgetControllerParams WidgetControllerParams;
+
+	TSharedPtr<FStreamableHandle> OverlayLoadHandle;
+	FTimerHandle OverlayBuildTimerHandle;
+
+	/** Message widgets, reused per widget class */
+	UPROPERTY(Transient)
+	FUserWidgetPool MessageWidgetPool;
+
+	struct FLiveMessage
+	{
+		TWeakObjectPtr<UAuraUserWidget> Widget;
+		FGameplayTag MessageTag;
+		double LastShownTime = 0.0;
+		double ExpireTime = 0.0;
+		int32 Count = 1;
+	};
+
+	/** Message widgets currently on screen, oldest first */
+	TArray<FLiveMessage> LiveMessages;
+
+	FTimerHandle MessageExpireTimerHandle;
+
+	void RemoveLiveMessage(int32 Index);
+	void ExpireMessageWidgets();
+	void ScheduleMessageExpiry();
 };
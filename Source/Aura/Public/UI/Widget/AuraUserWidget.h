@@ -6,6 +6,11 @@
 #include "Blueprint/UserWidget.h"
 #include "AuraUserWidget.generated.h"
 
+class UTexture2D;
+class UAuraUserWidget;
+
+DECLARE_DELEGATE_OneParam(FOnMessageWidgetFinished, UAuraUserWidget*);
+
 /**
  * A single purpose component that can be attached to locations on the hud and the viewport. It's normally a single "UI thing" or a logical grouping
  *  of "UI things".
@@ -41,8 +46,44 @@ public:
 	UPROPERTY(BlueprintReadOnly)
 	TObjectPtr<UObject> WidgetController;
 
+	/** 
+	* When set, this widget reports its visibility to its UAuraWidgetController, which stops listening to the ASC while none of its widgets is
+	*  visible (see UAuraWidgetController::SetWidgetVisibility). Only worth it for widgets that are hidden as a whole, like the overlay.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "WidgetController")
+	bool bDrivesWidgetControllerSubscriptions = false;
+
 protected:
 	/** BeginPlay like function for setting/initializing the widget controller to a user controller */
 	UFUNCTION(BlueprintImplementableEvent)
 	void WidgetControllerSet();
+
+	virtual void NativeConstruct() override;
+	virtual void NativeDestruct() override;
+
+private:
+	UFUNCTION()
+	void HandleVisibilityChanged(ESlateVisibility InVisibility);
+
+	void ReportVisibilityToWidgetController(bool bVisible) const;
+
+public:
+	/** 
+	* Message widgets are pooled by AAuraHUD, so the same instance is shown many times. This is called every time it's shown (or when an identical
+	*  message is merged into it, with Count > 1), so the BP should reset its text, image and animations here instead of in Construct.
+	*/
+	UFUNCTION(BlueprintImplementableEvent)
+	void MessageShown(const FText& Message, UTexture2D* Image, int32 Count);
+
+	/** Calls MessageShown. Animations the BP stops while restarting them in there don't count as the message being finished. */
+	void ShowMessage(const FText& Message, UTexture2D* Image, int32 Count);
+
+	/** Fired when the last playing animation of a message widget finishes, so the HUD can give it back to the pool */
+	FOnMessageWidgetFinished OnMessageFinished;
+
+protected:
+	virtual void OnAnimationFinished_Implementation(const UWidgetAnimation* Animation) override;
+
+private:
+	bool bShowingMessage = false;
 };
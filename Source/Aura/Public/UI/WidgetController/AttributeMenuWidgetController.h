@@ -0,0 +1,53 @@
+// Copyright Eveline Gomes.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "UI/WidgetController/AuraWidgetController.h"
+#include "AttributeMenuWidgetController.generated.h"
+
+// One delegate for every attribute: the tag tells the widgets which attribute the value belongs to
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FAttributeValueChangedSignature, FGameplayTag, AttributeTag, float, NewValue);
+
+/**
+ * Widget controller for the attribute menu (and any other widget showing attributes by tag).
+ * 
+ * Instead of one delegate and one binding per attribute, like the overlay controller has, widgets ask for the attributes they show by tag
+ *  (RequestAttribute, eg from each attribute row's Construct) and give them back when they go away (ReleaseAttribute, from Destruct). The controller
+ *  only binds to the ASC for attributes that have been requested and aren't released yet, and every change goes through OnAttributeValueChanged
+ *  with the attribute tag. A closed menu then has no binding at all, and adding an attribute to the menu only needs its tag in the registry
+ *  (UAuraAttributeSet::GetTagsToAttributes).
+ */
+UCLASS(BlueprintType, Blueprintable)
+class AURA_API UAttributeMenuWidgetController : public UAuraWidgetController
+{
+	GENERATED_BODY()
+
+public:
+	/** Begin UAuraWidgetController */
+	// Broadcast the current value of every requested attribute
+	virtual void BroadcastInitialValues() override;
+
+	// Bind to the requested attributes only
+	virtual void BindCallbacksToDependencies() override;
+	/** End UAuraWidgetController */
+
+	/** Start receiving AttributeTag changes. The current value is broadcast right away. Requests are counted, so each one needs a ReleaseAttribute. */
+	UFUNCTION(BlueprintCallable, Category = "GAS|Attributes")
+	void RequestAttribute(FGameplayTag AttributeTag);
+
+	/** Stop receiving AttributeTag changes. The binding is removed once every request for it has been released. */
+	UFUNCTION(BlueprintCallable, Category = "GAS|Attributes")
+	void ReleaseAttribute(FGameplayTag AttributeTag);
+
+	UPROPERTY(BlueprintAssignable, Category = "GAS|Attributes")
+	FAttributeValueChangedSignature OnAttributeValueChanged;
+
+private:
+	void BindAttribute(const FGameplayTag& AttributeTag, const FGameplayAttribute& Attribute);
+	void BroadcastAttribute(const FGameplayTag& AttributeTag, const FGameplayAttribute& Attribute);
+
+	/** Requested attribute tags and how many widgets requested each */
+	TMap<FGameplayTag, int32> AttributeRequests;
+};
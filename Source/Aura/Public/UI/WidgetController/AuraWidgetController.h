@@ -4,6 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+
+/** Attribute change subscriptions */
+#include "AbilitySystemComponent.h"
+#include "UObject/ObjectKey.h"
+
 #include "AuraWidgetController.generated.h"
 
 class UAttributeSet;
@@ -79,7 +84,42 @@ public:
 
 	virtual void BindCallbacksToDependencies();
 
+	/** Remove every callback bound in BindCallbacksToDependencies(). Children that bind to anything else than attributes should override it. */
+	virtual void UnbindCallbacksFromDependencies();
+
+	/** 
+	* Subscription lifecycle: while none of the widgets using this controller is visible (collapsed overlay during menus, cinematics or loading),
+	*  the controller unbinds from the ASC, so attribute changes cost nothing for it. Resuming binds again and sends a single snapshot through
+	*  BroadcastInitialValues(), so the widgets catch up with whatever changed while they were hidden.
+	* Widgets report their visibility with SetWidgetVisibility() (UAuraUserWidget does it when bDrivesWidgetControllerSubscriptions is set), or
+	*  the controller can be suspended and resumed directly.
+	*/
+	void SetWidgetVisibility(const UObject* Widget, bool bVisible);
+
+	UFUNCTION(BlueprintCallable, Category = "WidgetController")
+	void SuspendSubscriptions();
+
+	UFUNCTION(BlueprintCallable, Category = "WidgetController")
+	void ResumeSubscriptions();
+
+	UFUNCTION(BlueprintPure, Category = "WidgetController")
+	bool AreSubscriptionsSuspended() const { return bSubscriptionsSuspended; }
+
 protected:
+	/** 
+	* Bind Callback to the change delegate of Attribute and keep the handle, so UnbindCallbacksFromDependencies() can remove it later.
+	* The lambda is bound weakly to this controller, so it won't be called on a controller that has been garbage collected.
+	*/
+	template<typename FuncType>
+	void BindAttributeChange(const FGameplayAttribute& Attribute, FuncType&& Callback)
+	{
+		const FDelegateHandle Handle = AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(Attribute).AddWeakLambda(this, Forward<FuncType>(Callback));
+		AttributeChangeHandles.Emplace(Attribute, Handle);
+	}
+
+	/** Remove the callbacks BindAttributeChange() bound to Attribute */
+	void UnbindAttributeChange(const FGameplayAttribute& Attribute);
+
 	UPROPERTY(BlueprintReadOnly, Category = "WidgetController")
 	TObjectPtr<APlayerController> PlayerController;
 
@@ -91,4 +131,12 @@ protected:
 
 	UPROPERTY(BlueprintReadOnly, Category = "WidgetController")
 	TObjectPtr<UAttributeSet> AttributeSet;
+
+private:
+	TArray<TPair<FGameplayAttribute, FDelegateHandle>> AttributeChangeHandles;
+
+	/** Widgets that reported themselves visible */
+	TSet<FObjectKey> VisibleWidgets;
+
+	bool bSubscriptionsSuspended = false;
 };
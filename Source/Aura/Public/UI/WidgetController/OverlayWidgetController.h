@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Engine/DataTable.h"
+#include "Engine/EngineTypes.h"
 #include "GameplayTagContainer.h"
 
 #include "CoreMinimal.h"
@@ -76,8 +77,18 @@ public:
 	
 	// 
 	virtual void BindCallbacksToDependencies() override;
+
+	virtual void UnbindCallbacksFromDependencies() override;
 	/** End UAuraWidgetController */
 
+	/** 
+	* While the overlay is still being built (AAuraHUD creates it over several frames), nothing is bound to our delegates yet. Holding keeps the
+	*  attribute values and message rows that arrive in the meantime instead of broadcasting them to nobody, and releasing sends them once the
+	*  widget is listening: a snapshot of the attributes (their latest values) followed by the held messages.
+	*/
+	void HoldBroadcasts();
+	void ReleaseBroadcasts();
+
 	/** Delegates themselves */
 	UPROPERTY(BlueprintAssignable, Category="GAS|Attributes")
 	FOnAttributeChangedSignature OnHealthChanged;
@@ -102,6 +113,17 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Widget Data")
 	TObjectPtr<UDataTable> MessageWidgetDataTable;
 
+	/** Number of Message tags received that had no row in MessageWidgetDataTable */
+	UPROPERTY(BlueprintReadOnly, Category = "Widget Data")
+	int32 MissingMessageRowCount = 0;
+
+	/** 
+	* Minimum time between two broadcasts of the attribute delegates. Zero means at most one broadcast per attribute per frame, anything above
+	*  that also rate limits the widgets bound to this controller (eg 0.1 for 10 updates a second during DoT heavy fights).
+	*/
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Widget Data", meta = (ClampMin = "0.0"))
+	float MinBroadcastInterval = 0.f;
+
 	/** 
 	* Returns any type of DataTable (DT) row by using a DataTable and a Tag.
 	* This function is more versitle than what this class needs, so it's a good example of a function that could be placed in a static class (as a 
@@ -109,6 +131,48 @@ protected:
 	*/
 	template<typename T>
 	T* GetDataTableRowByTag(UDataTable* DataTable, const FGameplayTag& Tag);
+
+private:
+	/** 
+	* Flat index of MessageWidgetDataTable, built once in BindCallbacksToDependencies(), so the EffectAssetTags callback looks rows up by tag hash
+	*  instead of going through UDataTable::FindRow with the tag name.
+	*/
+	void BuildMessageRowIndex();
+
+	UPROPERTY(Transient)
+	TMap<FGameplayTag, FUIWidgetRow> MessageRowsByTag;
+
+	bool bMessageRowIndexBuilt = false;
+
+	FDelegateHandle EffectAssetTagsHandle;
+
+	bool bBroadcastsHeld = false;
+
+	/** Message rows received while holding broadcasts */
+	TArray<FUIWidgetRow> HeldMessageRows;
+
+	/** 
+	* Attribute UI bus: the attribute change callbacks only record the latest value of each attribute, and a single flush per frame (or per
+	*  MinBroadcastInterval) broadcasts each attribute that changed once. A burst of ticks in one frame then costs one Blueprint broadcast per
+	*  attribute instead of one per tick.
+	*/
+	enum class EOverlayAttribute : uint8
+	{
+		Health,
+		MaxHealth,
+		Mana,
+		MaxMana,
+		Num
+	};
+
+	void QueueAttributeBroadcast(EOverlayAttribute Attribute, float NewValue);
+	void FlushAttributeBroadcasts();
+	FOnAttributeChangedSignature& GetAttributeDelegate(EOverlayAttribute Attribute);
+
+	float PendingValues[static_cast<uint8>(EOverlayAttribute::Num)] = {};
+	uint8 DirtyAttributesMask = 0;
+	double LastFlushTime = 0.0;
+	FTimerHandle FlushTimerHandle;
 };
 
 template<typename T>
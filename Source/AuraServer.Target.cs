@@ -0,0 +1,15 @@
+// Copyright Eveline Gomes.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+public class AuraServerTarget : TargetRules
+{
+	public AuraServerTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Server;
+		DefaultBuildSettings = BuildSettingsVersion.V2;
+
+		ExtraModuleNames.AddRange( new string[] { "Aura" } );
+	}
+}